@@ -0,0 +1,91 @@
+// ustd-bench.cpp - cycles per queue push/pop for different queue sizes
+//
+// Usage: ustd-bench [rounds [size offset]]
+
+#include <chrono>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ustd_platform.h"
+
+#include "ustd_queue.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "cycles"
+inline unsigned long long benchClock() {
+    return __rdtsc();
+}
+#else
+#define BENCH_UNIT "ns"
+inline unsigned long long benchClock() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+#endif
+
+// Reference: ring buffer with modulo wraparound, as ustd::queue used before
+class moduloRing {
+  private:
+    unsigned char *que;
+    unsigned int maxSize, size, quePtr0, quePtr1;
+
+  public:
+    moduloRing(unsigned int maxSize)
+        : que((unsigned char *)malloc(maxSize)), maxSize(maxSize), size(0), quePtr0(0),
+          quePtr1(0) {
+    }
+    ~moduloRing() {
+        free(que);
+    }
+    bool push(unsigned char c) {
+        if (size >= maxSize)
+            return false;
+        que[quePtr1] = c;
+        quePtr1 = (quePtr1 + 1) % maxSize;
+        ++size;
+        return true;
+    }
+    unsigned char pop() {
+        if (size == 0)
+            return 0;
+        unsigned char c = que[quePtr0];
+        quePtr0 = (quePtr0 + 1) % maxSize;
+        --size;
+        return c;
+    }
+};
+
+volatile unsigned char sink;
+
+template <typename Q> double benchmark(Q &q, unsigned int rounds) {
+    // serial buffer pattern: bursts of 48 bytes are buffered and drained
+    unsigned long long start = benchClock();
+    for (unsigned int r = 0; r < rounds; r++) {
+        for (unsigned int i = 0; i < 48; i++)
+            q.push((unsigned char)i);
+        unsigned char s = 0;
+        for (unsigned int i = 0; i < 48; i++)
+            s += q.pop();
+        sink = s;
+    }
+    return (double)(benchClock() - start) / ((double)rounds * 48);
+}
+
+int main(int argc, char *argv[]) {
+    unsigned int rounds = argc > 1 ? atoi(argv[1]) : 200000;
+    unsigned int odd = 100 + (argc > 2 ? atoi(argv[2]) : 0);  // not a compile-time constant
+
+    moduloRing ref(odd);
+    ustd::queue<unsigned char> general(odd);
+    ustd::queue<unsigned char> pow2(128);
+
+    benchmark(ref, rounds / 10);  // warm up
+    printf("%s per push+pop, %u bursts of 48 bytes:\n", BENCH_UNIT, rounds);
+    printf("  modulo ring (reference), size %u: %6.2f\n", odd, benchmark(ref, rounds));
+    printf("  ustd::queue, size %u:              %6.2f\n", odd, benchmark(general, rounds));
+    printf("  ustd::queue, size 128 (masked):    %6.2f\n", benchmark(pow2, rounds));
+    return 0;
+}
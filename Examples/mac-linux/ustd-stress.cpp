@@ -0,0 +1,182 @@
+// ustd-stress.cpp - multi-threaded stress test of the lock-free queues
+//
+// Usage: ustd-stress [producers [consumers [items per producer]]]
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ustd_platform.h"
+
+#include "ustd_spsc_queue.h"
+#include "ustd_mpmc_queue.h"
+
+struct item {
+    unsigned int producer;
+    unsigned int seq;
+};
+
+bool stressSpsc(unsigned int items) {
+    ustd::spsc_queue<unsigned int> q(64);
+    std::thread producer([&] {
+        for (unsigned int i = 1; i <= items;) {
+            if (q.push(i))
+                ++i;
+            else
+                std::this_thread::yield();
+        }
+    });
+    bool ok = true;
+    unsigned int v;
+    for (unsigned int expect = 1; expect <= items;) {
+        if (q.pop(v)) {
+            if (v != expect)
+                ok = false;
+            ++expect;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    printf("spsc: %u items, peak %u of %u\n", items, q.peak(), q.capacity());
+    return ok && q.isEmpty() && q.peak() <= q.capacity();
+}
+
+bool stressMpmc(unsigned int producers, unsigned int consumers, unsigned int items) {
+    ustd::mpmc_queue<item> q(256);
+    std::atomic<unsigned int> received(0);
+    std::atomic<bool> ok(true);
+    std::vector<std::atomic<unsigned long>> sums(producers);
+    for (auto &s : sums)
+        s = 0;
+
+    std::vector<std::thread> threads;
+    for (unsigned int p = 0; p < producers; p++) {
+        threads.push_back(std::thread([&, p] {
+            item batch[8];
+            unsigned int seq = 0;
+            while (seq < items) {
+                if (seq % 3 == 0) {  // mix single and batch pushes
+                    unsigned int n = 0;
+                    while (n < 8 && seq + n < items) {
+                        batch[n] = {p, seq + n};
+                        ++n;
+                    }
+                    unsigned int pushed = q.tryPushN(batch, n);
+                    seq += pushed;
+                    if (pushed == 0)
+                        std::this_thread::yield();
+                } else if (q.tryPush(item{p, seq})) {
+                    ++seq;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        }));
+    }
+    unsigned int total = producers * items;
+    for (unsigned int c = 0; c < consumers; c++) {
+        threads.push_back(std::thread([&, c] {
+            // entries of one producer must arrive in order at each consumer
+            std::vector<long> last(producers, -1);
+            item batch[8];
+            while (received.load() < total) {
+                unsigned int n = c % 2 ? q.tryPopN(batch, 8) : (q.tryPop(batch[0]) ? 1 : 0);
+                if (n == 0) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                for (unsigned int i = 0; i < n; i++) {
+                    const item &it = batch[i];
+                    if (it.producer >= producers || (long)it.seq <= last[it.producer]) {
+                        ok = false;
+                        continue;
+                    }
+                    last[it.producer] = it.seq;
+                    sums[it.producer] += it.seq;
+                }
+                received += n;
+            }
+        }));
+    }
+    for (auto &t : threads)
+        t.join();
+
+    unsigned long expect = (unsigned long)items * (items - 1) / 2;
+    for (auto &s : sums) {
+        if (s != expect)
+            ok = false;
+    }
+    printf("mpmc: %u producers, %u consumers, %u items, peak %u of %u\n", producers, consumers,
+           received.load(), q.peak(), q.capacity());
+    return ok && received == total && q.isEmpty() && q.length() == 0 &&
+           q.peak() <= q.capacity();
+}
+
+bool stressMpmcStrings(unsigned int items) {
+    // non-trivial entries: every string must be constructed and destroyed once
+    ustd::mpmc_queue<std::string> q(16);
+    std::atomic<unsigned int> chars(0);
+    std::thread producer([&] {
+        for (unsigned int i = 0; i < items;) {
+            if (q.tryPush(std::string(i % 50, 'x')))
+                ++i;
+            else
+                std::this_thread::yield();
+        }
+    });
+    std::thread consumer([&] {
+        std::string s;
+        for (unsigned int i = 0; i < items;) {
+            if (q.tryPop(s)) {
+                chars += s.length();
+                ++i;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+    producer.join();
+    consumer.join();
+    unsigned int expect = 0;
+    for (unsigned int i = 0; i < items; i++)
+        expect += i % 50;
+    q.tryPush("left in the queue");  // destroyed by the destructor
+    return chars == expect;
+}
+
+int main(int argc, char *argv[]) {
+    unsigned int producers = argc > 1 ? atoi(argv[1]) : 4;
+    unsigned int consumers = argc > 2 ? atoi(argv[2]) : 4;
+    unsigned int items = argc > 3 ? atoi(argv[3]) : 100000;
+    bool aerr = false;
+
+    auto start = std::chrono::steady_clock::now();
+    if (!stressSpsc(items * producers)) {
+        printf("SPSC stress test failed!\n");
+        aerr = true;
+    }
+    if (!stressMpmc(producers, consumers, items)) {
+        printf("MPMC stress test failed!\n");
+        aerr = true;
+    }
+    if (!stressMpmcStrings(items / 10)) {
+        printf("MPMC string stress test failed!\n");
+        aerr = true;
+    }
+    long ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+
+    if (aerr) {
+        printf("Stress test failed!\n");
+        return 1;
+    }
+    printf("Stress test ok, %ld ms\n", ms);
+    return 0;
+}
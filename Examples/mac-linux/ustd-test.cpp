@@ -1,4 +1,7 @@
 #include <iostream>
+#include <algorithm>
+#include <functional>
+#include <numeric>
 #include <list>
 #include <string>
 
@@ -12,6 +15,21 @@
 #include "ustd_array.h"
 #include "ustd_map.h"
 #include "ustd_queue.h"
+#include "ustd_algorithm.h"
+#include "ustd_small_array.h"
+#include "ustd_static_array.h"
+#include "ustd_arena.h"
+#include "ustd_pool.h"
+#include "ustd_simd.h"
+#include "ustd_soa_array.h"
+#include "ustd_bitarray.h"
+#include "ustd_span.h"
+#include "ustd_flash_table.h"
+#include "ustd_shared_array.h"
+#include "ustd_shared_map.h"
+#include "ustd_chunked_array.h"
+#include "ustd_spsc_queue.h"
+#include "ustd_mpmc_queue.h"
 
 #include "ustd_functional.h"
 
@@ -40,13 +58,14 @@ bool queueIteratorCheck(queue<int> &que) {
     return true;
 }
 
-bool mapKeysIteratorCheck(map<int, int> mp) {
+bool mapKeysIteratorCheck(ustd::span<const int> keys, ustd::span<const int> values) {
+    // views of the key and value arrays, the map is not copied
     printf("Map Iterator: ");
-    for (auto n : mp.keysArray()) {
-        printf("%d -> %d | ", n, mp[n]);
+    for (unsigned int i = 0; i < keys.length(); i++) {
+        printf("%d -> %d | ", keys[i], values[i]);
     }
     printf("\n");
-    return true;
+    return keys.length() == values.length();
 }
 
 bool checkCopyAr(array<int> ar) {
@@ -100,8 +119,8 @@ bool constArrayInit() {
 }
 
 bool cpMap(map<int, int> mp, map<int, int> *pmp) {
-    mapKeysIteratorCheck(mp);
-    mapKeysIteratorCheck(*pmp);
+    mapKeysIteratorCheck(mp.keysArray(), mp.values);
+    mapKeysIteratorCheck(pmp->keysArray(), pmp->values);
     if (pmp->length() == mp.length()) {
         printf("Copy-map-length: %d\n", mp.length());
         return true;
@@ -120,6 +139,1248 @@ bool cpQue(queue<int> qu, queue<int> *pqu) {
     }
 }
 
+bool checkGrowth() {
+    array<int> lin(16, ARRAY_MAX_SIZE, 16);
+    array<int> geo(16, ARRAY_MAX_SIZE, 16, true, ustd::arrayGrowth::geometric());
+    array<int> cap(16, ARRAY_MAX_SIZE, 16, true, ustd::arrayGrowth::capped(200, 1000));
+    unsigned int linAllocs = 0, geoAllocs = 0, capAllocs = 0;
+    for (int i = 0; i < 10000; i++) {
+        unsigned int l = lin.alloclen(), g = geo.alloclen(), c = cap.alloclen();
+        lin.add(i);
+        geo.add(i);
+        cap.add(i);
+        if (lin.alloclen() != l)
+            ++linAllocs;
+        if (geo.alloclen() != g)
+            ++geoAllocs;
+        if (cap.alloclen() != c) {
+            if (cap.alloclen() - c > 1000) {
+                printf("Growth: capped step too large: %d\n", cap.alloclen() - c);
+                return false;
+            }
+            ++capAllocs;
+        }
+    }
+    printf("Growth reallocations for 10000 adds: linear=%d geometric=%d capped=%d\n", linAllocs,
+           geoAllocs, capAllocs);
+    if (geoAllocs >= capAllocs || capAllocs >= linAllocs)
+        return false;
+    for (int i = 0; i < 10000; i++) {
+        if (geo[i] != i || cap[i] != i) {
+            printf("Growth: err at: %d\n", i);
+            return false;
+        }
+    }
+    // Large sizes must not overflow the growth step with 32 bit arithmetic
+    ustd::arrayGrowth g150 = ustd::arrayGrowth::geometric(150);
+    if (g150.next(3000000000u, 16, 4000000000u) != 4000000000u ||
+        g150.next(2000000000u, 16, 4000000000u) != 3000000000u ||
+        g150.next(1001, 16, 10000) != 1501 || g150.next(10, 16, 10000) != 26) {
+        printf("Growth: large sizes failed\n");
+        return false;
+    }
+    // Hysteresis: alternating add/erase at an allocation boundary must not reallocate
+    array<int> hy(16, ARRAY_MAX_SIZE, 16);
+    for (int i = 0; i < 32; i++)
+        hy.add(i);
+    unsigned int al = hy.alloclen();
+    for (int i = 0; i < 10; i++) {
+        int v = 0;
+        hy.add(v);
+        hy.erase(hy.length() - 1);
+        hy.erase(hy.length() - 1);
+        hy.add(v);
+    }
+    if (hy.alloclen() != al + 16) {
+        printf("Growth: hysteresis failed, alloc=%d\n", hy.alloclen());
+        return false;
+    }
+    while (hy.length() > 1)
+        hy.erase(0);
+    if (hy.alloclen() > 32) {
+        printf("Growth: shrink failed, alloc=%d\n", hy.alloclen());
+        return false;
+    }
+    map<int, int> gm(16, ARRAY_MAX_SIZE, 16, true, ustd::arrayGrowth::geometric(150));
+    for (int i = 0; i < 1000; i++)
+        gm[i] = i;
+    if (gm.length() != 1000 || gm.keys.alloclen() != gm.values.alloclen())
+        return false;
+    return true;
+}
+
+struct copyCounter {
+    static int copies;
+    int v;
+    copyCounter(int v = 0) : v(v) {
+    }
+    copyCounter(const copyCounter &o) : v(o.v) {
+        ++copies;
+    }
+    copyCounter(copyCounter &&o) : v(o.v) {
+    }
+    copyCounter &operator=(const copyCounter &o) {
+        v = o.v;
+        ++copies;
+        return *this;
+    }
+    copyCounter &operator=(copyCounter &&o) {
+        v = o.v;
+        return *this;
+    }
+};
+int copyCounter::copies = 0;
+
+array<copyCounter> makeCounterArray(int n) {
+    array<copyCounter> ar(4, ARRAY_MAX_SIZE, 4);
+    for (int i = 0; i < n; i++)
+        ar.emplace(i);
+    return ar;
+}
+
+bool checkMove() {
+    copyCounter::copies = 0;
+    array<copyCounter> ar = makeCounterArray(100);
+    copyCounter c(100);
+    ar.add(static_cast<copyCounter &&>(c));
+    array<copyCounter> moved(static_cast<array<copyCounter> &&>(ar));
+    if (copyCounter::copies != 0) {
+        printf("Move: %d copies\n", copyCounter::copies);
+        return false;
+    }
+    if (ar.length() != 0 || moved.length() != 101 || moved[100].v != 100)
+        return false;
+    ar.add(c);  // moved-from array is reusable
+    array<copyCounter> cp;
+    cp = moved;
+    if (cp.length() != 101 || cp[50].v != 50 || ar.length() != 1)
+        return false;
+    array<String> sa;
+    for (int i = 0; i < 100; i++)
+        sa.add(String("a string that is too long for small string optimization ") +
+               std::to_string(i));
+    if (sa[99] != "a string that is too long for small string optimization 99")
+        return false;
+    map<int, String> ms;
+    ms[1] = "one";
+    map<int, String> ms2(static_cast<map<int, String> &&>(ms));
+    if (ms2[1] != "one")
+        return false;
+    return true;
+}
+
+struct liveCounter {
+    static int live;
+    int v;
+    liveCounter(int v = 0) : v(v) {
+        ++live;
+    }
+    liveCounter(const liveCounter &o) : v(o.v) {
+        ++live;
+    }
+    liveCounter &operator=(const liveCounter &o) = default;
+    ~liveCounter() {
+        --live;
+    }
+};
+int liveCounter::live = 0;
+
+bool checkLifetime() {
+    {
+        array<liveCounter> ar(1000, ARRAY_MAX_SIZE, 16);
+        if (liveCounter::live != 1) {  // only the invalid-value entry
+            printf("Lifetime: %d live objects in empty array\n", liveCounter::live);
+            return false;
+        }
+        for (int i = 0; i < 2000; i++)
+            ar.emplace(i);
+        for (int i = 0; i < 1500; i++)
+            ar.erase(0);
+        if (liveCounter::live != 501 || ar[0].v != 1500)
+            return false;
+        ar[509].v = 1;  // writing past the end constructs the gap
+        if (liveCounter::live != 511 || ar[505].v != 0)
+            return false;
+        array<liveCounter> cp(ar);
+        cp.erase();
+        if (liveCounter::live != 512 || cp.length() != 0)
+            return false;
+    }
+    if (liveCounter::live != 0) {
+        printf("Lifetime: %d objects leaked\n", liveCounter::live);
+        return false;
+    }
+    return true;
+}
+
+struct sensorRecord {
+    unsigned long timestamp;
+    float value;
+};
+
+bool checkTrivialPaths() {
+    static_assert(ustd::details::isTrivial<float>::value, "float must use memcpy path");
+    static_assert(ustd::details::isTrivial<sensorRecord>::value, "POD must use memcpy path");
+    static_assert(!ustd::details::isTrivial<String>::value, "String must use element path");
+    array<float> fa(4, ARRAY_MAX_SIZE, 4);
+    for (int i = 0; i < 1000; i++)
+        fa.add((float)i);
+    for (int i = 0; i < 500; i++)
+        fa.erase(0);
+    for (unsigned int i = 0; i < fa.length(); i++) {
+        if (fa[i] != (float)(i + 500)) {
+            printf("Trivial: float err at %d\n", i);
+            return false;
+        }
+    }
+    array<sensorRecord> ra;
+    for (int i = 0; i < 100; i++)
+        ra.add({(unsigned long)i, i * 0.5f});
+    array<sensorRecord> rb(ra);
+    if (rb.length() != 100 || rb[99].timestamp != 99 || rb[99].value != 49.5f)
+        return false;
+    queue<String> sq(8);
+    for (int i = 0; i < 20; i++) {
+        sq.push(String("queued string that does not fit small buffers ") + std::to_string(i));
+        if (sq.length() > 5)
+            sq.pop();
+    }
+    queue<String> sq2(sq);
+    if (sq2.length() != 5 || sq2.pop() != sq.pop())
+        return false;
+    return true;
+}
+
+bool checkSmallArray() {
+    ustd::small_array<String, 4> sa;
+    for (int i = 0; i < 4; i++)
+        sa.add(std::to_string(i));
+    if (!sa.isInline() || sa.length() != 4)
+        return false;
+    sa.add("4");
+    if (sa.isInline() || sa[4] != "4")
+        return false;
+    ustd::small_array<String, 4> moved(static_cast<ustd::small_array<String, 4> &&>(sa));
+    ustd::small_array<String, 4> copied(moved);
+    while (moved.length() > 2)
+        moved.erase(0);
+    if (!moved.isInline() || moved[0] != "3" || moved[1] != "4")
+        return false;
+    ustd::small_array<String, 4> inl(moved);
+    ustd::small_array<String, 4> inl2(static_cast<ustd::small_array<String, 4> &&>(inl));
+    if (!inl2.isInline() || inl2.length() != 2 || inl.length() != 0)
+        return false;
+    int n = 0;
+    for (auto &s : copied) {
+        if (s != std::to_string(n++))
+            return false;
+    }
+    const int ci[] = {1, 2, 3, 4, 5, 6};
+    ustd::small_array<int, 8> ia(ci, 6);
+    ia[7] = 8;
+    if (!ia.isInline() || ia.length() != 8 || ia[6] != 0 || ia[5] != 6)
+        return false;
+    ustd::small_array<int, 2> fixed(2, 0);
+    if (fixed.add(1) != 0 || fixed.add(2) != 1 || fixed.add(3) != -1)
+        return false;
+    return n == 5;
+}
+
+ustd::static_array<int, 8> globalTable;  // lives in .bss, no constructor allocation
+
+bool checkStaticArray() {
+    static_assert(ustd::static_array<int, 8>::capacity() == 8, "capacity must be constexpr");
+    for (int i = 0; i < 10; i++) {
+        int r = globalTable.add(i);
+        if ((i < 8 && r != i) || (i >= 8 && r != -1))
+            return false;
+    }
+    if (!globalTable.isFull())
+        return false;
+    globalTable.erase(0);
+    int sum = 0;
+    for (auto v : globalTable)
+        sum += v;
+    if (sum != 28 || globalTable.length() != 7)
+        return false;
+    ustd::static_array<String, 3> sa;
+    sa.emplace("a");
+    sa[2] = "c";
+    ustd::static_array<String, 3> sb(sa);
+    if (sb.length() != 3 || sb[1] != "" || sb[2] != "c")
+        return false;
+    return true;
+}
+
+bool checkRanges() {
+    const int ci[] = {100, 101, 102, 103, 104};
+    array<int> ia(4, ARRAY_MAX_SIZE, 4);
+    for (int i = 0; i < 10; i++)
+        ia.add(i);
+    if (!ia.insert(3, ci, 5) || ia.length() != 15 || ia[3] != 100 || ia[7] != 104 || ia[8] != 3)
+        return false;
+    if (!ia.eraseRange(3, 5) || ia.length() != 10)
+        return false;
+    for (int i = 0; i < 10; i++) {
+        if (ia[i] != i)
+            return false;
+    }
+    if (!ia.addRange(ia) || ia.length() != 20 || ia[19] != 9)  // self-append
+        return false;
+    if (ia.insert(21, ci, 1) || ia.eraseRange(15, 6))
+        return false;
+    ia.clear();
+    if (ia.length() != 0 || ia.alloclen() < 20 || !ia.reserve(1000) || ia.alloclen() != 1000)
+        return false;
+    array<int> fixed(4, 4, 0);
+    if (fixed.reserve(5) || !fixed.addRange(ci, 4) || fixed.addRange(ci, 1))
+        return false;
+
+    liveCounter::live = 0;
+    {
+        array<liveCounter> la(2, ARRAY_MAX_SIZE, 2);
+        liveCounter lc[3] = {liveCounter(7), liveCounter(8), liveCounter(9)};
+        for (int i = 0; i < 6; i++)
+            la.emplace(i);
+        la.insert(1, lc, 3);  // grows
+        la.insert(0, lc, 3);  // grows again, or shifts in place
+        la.reserve(100);
+        la.insert(4, lc, 3);  // shift in place
+        int expect[] = {7, 8, 9, 0, 7, 8, 9, 7, 8, 9, 1, 2, 3, 4, 5};
+        if (la.length() != 15)
+            return false;
+        for (unsigned int i = 0; i < 15; i++) {
+            if (la[i].v != expect[i])
+                return false;
+        }
+        la.eraseRange(0, 10);
+        if (liveCounter::live != 5 + 3 + 1 || la[0].v != 1)
+            return false;
+    }
+    return liveCounter::live == 0;
+}
+
+bool checkUnorderedErase() {
+    array<int> ia;
+    for (int i = 0; i < 10; i++)
+        ia.add(i);
+    if (!ia.eraseUnordered(2) || ia[2] != 9 || ia.length() != 9)
+        return false;
+    if (!ia.eraseUnordered(8) || ia.length() != 8 || ia.eraseUnordered(8))
+        return false;
+    map<int, String> ms;
+    for (int i = 0; i < 10; i++)
+        ms[i] = std::to_string(i);
+    if (ms.eraseUnordered(3) != 3 || ms.length() != 9 || ms.eraseUnordered(3) != -1)
+        return false;
+    if (ms.erase(5) == -1 || ms.length() != 8)
+        return false;
+    for (auto k : ms.keysArray()) {
+        if (ms[k] != std::to_string(k) || k == 3 || k == 5)
+            return false;
+    }
+    return true;
+}
+
+bool descending(const int &a, const int &b) {
+    return a > b;
+}
+
+struct keyed {
+    int key;
+    int seq;
+    bool operator<(const keyed &o) const {
+        return key < o.key;
+    }
+};
+
+bool checkAlgorithms() {
+    unsigned long rnd = 12345;
+    for (int pattern = 0; pattern < 4; pattern++) {
+        array<int> ar(16, ARRAY_MAX_SIZE, 16, true, ustd::arrayGrowth::geometric());
+        for (int i = 0; i < 5000; i++) {
+            rnd = rnd * 1103515245 + 12345;
+            int v = pattern == 0 ? (int)((rnd >> 8) % 1000) : pattern == 1 ? i : pattern == 2 ? -i : 7;
+            ar.add(v);
+        }
+        array<int> cp(ar);
+        ustd::sort(ar);
+        for (unsigned int i = 1; i < ar.length(); i++) {
+            if (ar[i - 1] > ar[i]) {
+                printf("Algorithm: sort failed, pattern %d at %d\n", pattern, i);
+                return false;
+            }
+        }
+        unsigned int mid = cp.length() / 2;
+        ustd::nthElement(cp, mid);
+        for (unsigned int i = 0; i < cp.length(); i++) {
+            if ((i < mid && cp[i] > cp[mid]) || (i > mid && cp[i] < cp[mid]) || cp[mid] != ar[mid]) {
+                printf("Algorithm: nthElement failed, pattern %d at %d\n", pattern, i);
+                return false;
+            }
+        }
+        ustd::sort(ar, descending);
+        if (ar[0] < ar[ar.length() - 1])
+            return false;
+        std::function<bool(const int &, const int &)> asc = [](const int &a, const int &b) {
+            return a < b;
+        };
+        ustd::sort(ar, asc);
+        if (ustd::lowerBound(ar, ar[100]) > 100 || ustd::upperBound(ar, ar[100]) <= 100)
+            return false;
+        if (ar[ustd::binarySearch(ar, ar[4321])] != ar[4321] || ustd::binarySearch(ar, 5000) != -1)
+            return false;
+    }
+    keyed ks[1000], buf[500];
+    for (int i = 0; i < 1000; i++) {
+        rnd = rnd * 1103515245 + 12345;
+        ks[i] = {(int)((rnd >> 8) % 10), i};
+    }
+    ustd::stableSort(ks, ks + 1000, buf);
+    for (int i = 1; i < 1000; i++) {
+        if (ks[i - 1].key > ks[i].key || (ks[i - 1].key == ks[i].key && ks[i - 1].seq > ks[i].seq)) {
+            printf("Algorithm: stableSort failed at %d\n", i);
+            return false;
+        }
+    }
+    array<int> pa;
+    for (int i = 0; i < 100; i++)
+        pa.add(i);
+    unsigned int p = ustd::partition(pa, [](const int &v) { return v % 3 == 0; });
+    if (p != 34)
+        return false;
+    for (unsigned int i = 0; i < pa.length(); i++) {
+        if ((pa[i] % 3 == 0) != (i < p))
+            return false;
+    }
+    return true;
+}
+
+bool checkIterators() {
+    array<int> ar;
+    for (int i = 0; i < 100; i++)
+        ar.add(99 - i);
+    std::sort(ar.begin(), ar.end());
+    if (!std::is_sorted(ar.begin(), ar.end()) || ar.end() - ar.begin() != 100)
+        return false;
+    const array<int> &car = ar;
+    auto lb = std::lower_bound(car.begin(), car.end(), 42);
+    if (*lb != 42 || lb - car.begin() != 42 || lb[1] != 43 || *(lb - 2) != 40)
+        return false;
+    ustd::arrayIterator<const int> cit = ar.begin();
+    if (std::accumulate(cit, car.end(), 0) != 4950)
+        return false;
+    array<String> sa;
+    sa.add("abc");
+    if (sa.begin()->length() != 3)
+        return false;
+
+    queue<int> qu(8);
+    for (int i = 0; i < 12; i++) {
+        qu.push(i);
+        if (qu.length() > 6)
+            qu.pop();
+    }
+    qu.push(100);
+    qu.push(-1);  // full queue, wrapped around
+    if (std::distance(qu.begin(), qu.end()) != 8)
+        return false;
+    std::sort(qu.begin(), qu.end());
+    int expect[] = {-1, 6, 7, 8, 9, 10, 11, 100};
+    if (!std::equal(qu.begin(), qu.end(), expect))
+        return false;
+    std::reverse(qu.begin(), qu.end());
+    if (qu.begin()[0] != 100 || *(qu.end() - 1) != -1 || qu.pop() != 100)
+        return false;
+    const queue<int> &cqu = qu;
+    ustd::queueIterator<const int> cqit = qu.begin();  // wrapped start
+    if (std::accumulate(cqit, cqu.end(), 0) != 11 + 10 + 9 + 8 + 7 + 6 - 1 || cqit[6] != -1)
+        return false;
+    return true;
+}
+
+struct allocStats {
+    long bytes;
+    int blocks;
+};
+
+class countingAllocator {
+    // keeps track of the bytes in use, deallocate() must get the allocated size
+  public:
+    allocStats *stats;
+    countingAllocator(allocStats *stats = nullptr) : stats(stats) {
+    }
+    void *allocate(size_t bytes) {
+        stats->bytes += bytes;
+        ++stats->blocks;
+        return malloc(bytes);
+    }
+    void deallocate(void *p, size_t bytes) {
+        stats->bytes -= bytes;
+        --stats->blocks;
+        free(p);
+    }
+    void *reallocate(void *p, size_t oldBytes, size_t newBytes) {
+        void *pn = realloc(p, newBytes);
+        if (pn != nullptr) {
+            stats->bytes += (long)newBytes - (long)oldBytes;
+            if (p == nullptr)
+                ++stats->blocks;
+        }
+        return pn;
+    }
+};
+
+bool checkAllocator() {
+    allocStats st = {0, 0};
+    countingAllocator ca(&st);
+    {
+        array<int, countingAllocator> ar(4, ARRAY_MAX_SIZE, 4, true, ustd::arrayGrowth(), ca);
+        for (int i = 0; i < 100; i++)
+            ar.add(i);
+        if (st.blocks != 1 || st.bytes != (long)(ar.alloclen() * sizeof(int)))
+            return false;
+        int ins[] = {-1, -2, -3};
+        ar.insert(50, ins, 3);
+        ar.eraseRange(0, 90);
+        array<int, countingAllocator> cp(ar);
+        cp = ar;
+        array<int, countingAllocator> mv(static_cast<array<int, countingAllocator> &&>(cp));
+        if (st.blocks != 2 || mv.length() != 13 || mv[0] != 87)
+            return false;
+
+        array<String, countingAllocator> sa(2, ARRAY_MAX_SIZE, 2, true, ustd::arrayGrowth(), ca);
+        for (int i = 0; i < 20; i++)
+            sa.add(String(i + 1, 's'));
+        String ins2[] = {"x"};
+        sa.insert(1, ins2, 1);
+        sa.erase(0);
+        if (sa[0] != "x" || sa.length() != 20)
+            return false;
+
+        map<int, int, countingAllocator> mp(2, ARRAY_MAX_SIZE, 2, true, ustd::arrayGrowth(), ca);
+        for (int i = 0; i < 30; i++)
+            mp[i] = i * 2;
+        mp.erase(3);
+        map<int, int, countingAllocator> mp2(mp);
+        if (mp2[29] != 58 || mp2.find(3) != -1)
+            return false;
+
+        queue<String, countingAllocator> qu(4, ca);
+        qu.push("a");
+        qu.push("b");
+        queue<String, countingAllocator> qu2(qu);
+        if (qu2.pop() != "a" || st.blocks != 9)
+            return false;
+
+        typedef ustd::small_array<String, 2, countingAllocator> smallStrings;
+        smallStrings sm(ARRAY_MAX_SIZE, 2, true, ustd::arrayGrowth(), ca);
+        sm.add("a");
+        sm.add("b");
+        if (st.blocks != 9 || !sm.isInline())
+            return false;
+        for (int i = 0; i < 5; i++)
+            sm.add("c");  // spills to the heap of ca
+        smallStrings sm2(sm);
+        smallStrings sm3(static_cast<smallStrings &&>(sm2));
+        if (st.blocks != 11 || sm3.length() != 7 || sm3[0] != "a")
+            return false;
+        while (sm3.length() > 1)
+            sm3.erase(0);  // back inline, the heap memory is returned
+        if (st.blocks != 10 || !sm3.isInline())
+            return false;
+    }
+    return st.bytes == 0 && st.blocks == 0;
+}
+
+bool checkArena() {
+    alignas(16) unsigned char buffer[1024];
+    ustd::arena ar(buffer, sizeof(buffer));
+    void *p1 = ar.allocate(3);
+    void *p2 = ar.allocate(8);
+    if (p1 != buffer || (size_t)p2 % ARENA_ALIGN != 0 || ar.used() != ARENA_ALIGN + 8)
+        return false;
+    ar.deallocate(p2, 8);  // most recent block is returned immediately
+    if (ar.used() != 3 || ar.allocate(2000) != nullptr || ar.failures() != 1)
+        return false;
+    ar.reset();
+    if (ar.used() != 0 || ar.peak() != ARENA_ALIGN + 8)
+        return false;
+
+    {
+        ustd::arenaScope scope(ar);
+        array<int, ustd::arenaAllocator> ia(4, ARRAY_MAX_SIZE, 4, true, ustd::arrayGrowth(),
+                                            ustd::arenaAllocator(ar));
+        for (int i = 0; i < 100; i++)
+            ia.add(i);
+        // the array is the last allocation, so it grows in place
+        if (ia.data() != (int *)buffer || ar.used() != ia.alloclen() * sizeof(int))
+            return false;
+        map<int, int, ustd::arenaAllocator> mp(4, ARRAY_MAX_SIZE, 4, true,
+                                               ustd::arrayGrowth(), ustd::arenaAllocator(ar));
+        for (int i = 0; i < 20; i++)
+            mp[i] = ia[i] * 2;
+        queue<String, ustd::arenaAllocator> qu(4, ustd::arenaAllocator(ar));
+        qu.push("abc");
+        if (mp[19] != 38 || qu.pop() != "abc" || ar.peak() > sizeof(buffer))
+            return false;
+    }
+    if (ar.used() != 0)
+        return false;
+
+    ustd::arena heapArena(64);
+    array<int, ustd::arenaAllocator> big(4, 1000, 4, true, ustd::arrayGrowth(),
+                                         ustd::arenaAllocator(heapArena));
+    for (int i = 0; i < 100; i++)
+        big.add(i);
+    if (heapArena.capacity() != 64 || big.length() != 16 || heapArena.failures() == 0)
+        return false;
+
+    // self-insert needs a temporary copy: no room for it in the arena
+    alignas(16) unsigned char small[140];
+    ustd::arena tight(small, sizeof(small));
+    array<int, ustd::arenaAllocator> full(32, 32, 0, false, ustd::arrayGrowth(),
+                                          ustd::arenaAllocator(tight));
+    for (int i = 0; i < 8; i++)
+        full.add(i);
+    return !full.insert(0, full.data(), 8) && full.length() == 8 && full[7] == 7;
+}
+
+bool checkPool() {
+    liveCounter::live = 0;
+    ustd::pool<liveCounter, 4> lp;
+    liveCounter *objs[5];
+    for (int i = 0; i < 5; i++)
+        objs[i] = lp.construct(i);
+    if (objs[4] != nullptr || lp.freeCount() != 0 || liveCounter::live != 4 || objs[2]->v != 2)
+        return false;
+    lp.destroy(objs[1]);
+    lp.destroy(objs[3]);
+    liveCounter *reused = lp.construct(7);  // most recently freed block first
+    if (reused != objs[3] || lp.length() != 3 || lp.peak() != 4 || !lp.owns(reused) ||
+        lp.owns(&objs))
+        return false;
+    lp.destroy(reused);
+    lp.destroy(objs[0]);
+    lp.destroy(objs[2]);
+    if (liveCounter::live != 0 || !lp.isEmpty() || lp.freeCount() != 4)
+        return false;
+
+    ustd::pool<double> hp(100);
+    double *d = hp.construct(3.5);
+    if (hp.capacity() != 100 || *d != 3.5 || (size_t)d % alignof(double) != 0)
+        return false;
+    hp.destroy(d);
+
+    typedef ustd::pool<int[8], 2> bufferPool;
+    typedef ustd::poolAllocator<bufferPool> bufferAlloc;
+    bufferPool buffers;
+    {
+        queue<int, bufferAlloc> q1(8, bufferAlloc(buffers));
+        queue<int, bufferAlloc> q2(q1);
+        queue<int, bufferAlloc> q3(9, bufferAlloc(buffers));  // too large for a block
+        array<int, bufferAlloc> ar(8, 8, 0, false, ustd::arrayGrowth(), bufferAlloc(buffers));
+        for (int i = 0; i < 10; i++)
+            q1.push(i);
+        if (q1.length() != 8 || q2.push(1) != true || q3.push(1) != false || ar.add(1) != -1 ||
+            buffers.freeCount() != 0)
+            return false;
+    }
+    return buffers.isEmpty() && buffers.peak() == 2;
+}
+
+template <typename T> bool checkSimdType(T scale) {
+    // compare the vector kernels with a plain loop on all lengths and offsets
+    T data[80];
+    for (int i = 0; i < 80; i++)
+        data[i] = (T)((i * 37 + 11) % 23) * scale;
+    data[61] = (T)100 * scale;
+    data[5] = (T)-3 * scale;
+    for (int off = 0; off < 4; off++) {
+        for (int n = 0; n + off <= 80; n++) {
+            const T *first = data + off;
+            const T *last = first + n;
+            T needle = data[(off + n / 2) % 80];
+            int idx = -1;
+            unsigned int cnt = 0;
+            T lo = n ? *first : T(), hi = n ? *first : T(), s = T();
+            for (const T *p = first; p != last; p++) {
+                if (*p == needle) {
+                    if (idx == -1)
+                        idx = (int)(p - first);
+                    ++cnt;
+                }
+                if (*p < lo)
+                    lo = *p;
+                if (hi < *p)
+                    hi = *p;
+                s += *p;
+            }
+            if (ustd::indexOf(first, last, needle) != idx ||
+                ustd::count(first, last, needle) != cnt || ustd::contains(first, last, needle) != (idx != -1) ||
+                ustd::minValue(first, last) != lo || ustd::maxValue(first, last) != hi ||
+                ustd::sum(first, last) != s)
+                return false;
+        }
+    }
+    return true;
+}
+
+bool checkSimd() {
+    if (!checkSimdType<int>(1) || !checkSimdType<unsigned int>(1) ||
+        !checkSimdType<float>(0.5f) || !checkSimdType<long>(1) || !checkSimdType<double>(0.25))
+        return false;
+    if (!checkSimdType<signed char>(1) || !checkSimdType<unsigned char>(1) ||
+        !checkSimdType<char>(1) || !checkSimdType<short>(1) ||
+        !checkSimdType<unsigned short>(1) || !checkSimdType<long long>(1) ||
+        !checkSimdType<unsigned long>(1))
+        return false;
+    // 64 bit keys that differ only in one half
+    unsigned long long wide[7] = {5, 0x500000000ull, 0x500000005ull, 7, 5ull << 32, 0, 5};
+    if (ustd::indexOf(wide, wide + 7, 0x500000005ull) != 2 ||
+        ustd::count(wide, wide + 7, 5ull) != 2 || ustd::indexOf(wide, wide + 6, 5ull << 32) != 1)
+        return false;
+    map<unsigned char, int> pins;
+    for (int i = 0; i < 200; i++)
+        pins[(unsigned char)(i + 20)] = i;
+    if (pins.find(20) != 0 || pins.find(219) != 199 || pins.find(220) != -1 || pins[120] != 100)
+        return false;
+    unsigned int big[9] = {1, 0x80000000u, 3, 0xffffffffu, 5, 6, 7, 8, 9};
+    if (ustd::maxValue(big, big + 9) != 0xffffffffu || ustd::minValue(big, big + 9) != 1)
+        return false;
+    array<int> ar;
+    for (int i = 0; i < 1000; i++)
+        ar.add(i % 100);
+    if (ustd::indexOf(ar, 42) != 42 || ustd::count(ar, 42) != 10 || ustd::contains(ar, 100) ||
+        ustd::sum(ar) != 49500 || ustd::maxValue(ar) != 99)
+        return false;
+    map<int, int> mp;
+    for (int i = 0; i < 500; i++)
+        mp[i * 3] = i;
+    if (mp.find(300) != 100 || mp.find(301) != -1 || mp[1497] != 499 || mp.erase(3) != 1 ||
+        mp.find(6) != 1)
+        return false;
+    map<String, int> ms;
+    ms["a"] = 1;
+    ms["b"] = 2;
+    return ms.find("b") == 1 && ms["a"] == 1;
+}
+
+bool checkSoaArray() {
+    // columns: timestamp, sensor id, value, name
+    ustd::soa_array<unsigned long, int, float, String> tm(4, 100, 4);
+    for (int i = 0; i < 50; i++)
+        tm.add(1000 + i, i % 5, i * 0.5f, String(1 + i % 3, 'x'));
+    if (tm.length() != 50 || tm.columns() != 4 || tm.column<1>().length() != 50 ||
+        ustd::sum(tm.column<1>()) != 100 || ustd::count(tm.column<1>(), 4) != 10 ||
+        ustd::maxValue(tm.column<2>()) != 24.5f || tm.get<3>(4) != "xx")
+        return false;
+    tm.get<2>(0) = 99.0f;
+    tm.data<1>()[1] = -1;
+    if (ustd::maxValue(tm.column<2>()) != 99.0f || ustd::minValue(tm.column<1>()) != -1)
+        return false;
+    tm.erase(0);
+    tm.eraseUnordered(0);  // row 49 moves to index 0
+    if (tm.length() != 48 || tm.get<0>(0) != 1049 || tm.get<3>(0) != "xx" || tm.get<0>(1) != 1002)
+        return false;
+    unsigned long ts = 0;
+    unsigned int rows = 0;
+    for (auto r : tm) {
+        ts += r.get<0>();
+        if (r.get<1>() != tm[r.rowIndex()].get<1>())
+            return false;
+        ++rows;
+    }
+    if (rows != 48 || ts != ustd::sum(tm.column<0>()))
+        return false;
+    ustd::soa_array<int, int> full(2, 2, 0);
+    full.add(1, 2);
+    full.add(3, 4);
+    if (full.add(5, 6) != -1 || full.length() != 2 || full.column<1>().length() != 2)
+        return false;
+    tm.erase();
+    return tm.isEmpty() && tm.column<3>().length() == 0;
+}
+
+bool checkBitarray() {
+    ustd::bitarray flags(32, 32, 0, false);  // static
+    if (!flags.set(3) || !flags.set(31) || flags.set(32) || flags.length() != 32 ||
+        flags.alloclen() < 32)
+        return false;
+    if (!flags.test(3) || flags.test(4) || flags[31] != true || flags.count() != 2 ||
+        flags.findFirst() != 3 || flags.findNext(4) != 31 || flags.findNext(32) != -1)
+        return false;
+    flags.reset(3);
+    flags.flip(5);
+    if (flags.test(3) || !flags.test(5) || flags.findFirst() != 5)
+        return false;
+    flags.setAll();
+    if (!flags.all() || flags.count() != 32)
+        return false;
+
+    ustd::bitarray a, b;
+    for (unsigned int i = 0; i < 300; i += 3)
+        a.set(i);
+    for (unsigned int i = 0; i < 500; i += 5)
+        b.set(i);
+    if (a.length() != 298 || a.count() != 100 || b.count() != 100 || a.test(1000))
+        return false;
+    ustd::bitarray c = a;
+    c &= b;  // multiples of 15 below 298
+    if (c.count() != 20 || c.findFirst() != 0 || c.findNext(1) != 15 || c.length() != 298)
+        return false;
+    c = a;
+    c |= b;
+    if (c.length() != 496 || c.count() != 100 + 100 - 20)
+        return false;
+    c = a;
+    c ^= b;
+    if (c.count() != 200 - 40 || c.test(15) || !c.test(3) || !c.test(495))
+        return false;
+    int n = 0;
+    for (int i = c.findFirst(); i != -1; i = c.findNext(i + 1))
+        ++n;
+    if (n != 160)
+        return false;
+    c.resize(10);
+    if (c.length() != 10 || c.count() != 4)  // 3, 5, 6, 9
+        return false;
+    c.clear();
+    if (!c.none() || c.any() || !c.erase() || c.length() != 0)
+        return false;
+
+    // growing by many words allocates once, exactly the needed words
+    ustd::bitarray big;
+    unsigned int bits = (1u << 20) + 40;
+    if (!big.resize(bits) || big.length() != bits || big.count() != 0)
+        return false;
+    const unsigned int wb = sizeof(ustd::details::bitWord) * 8;
+    return big.alloclen() == (bits + wb - 1) / wb * wb;
+}
+
+int spanTotal(ustd::span<const int> values) {
+    int s = 0;
+    for (auto v : values)
+        s += v;
+    return s;
+}
+
+void spanDouble(ustd::span<int> values) {
+    for (auto &v : values)
+        v *= 2;
+}
+
+bool checkSpan() {
+    static const int table[] = {5, 1, 4, 2, 3};
+    if (spanTotal(table) != 15 || ustd::span<const int>(table).data() != table)
+        return false;
+    array<int> ar(table, 5);
+    ustd::static_array<int, 8> sa(table, 5);
+    ustd::small_array<int, 4> sm(table, 5);
+    const array<int> &car = ar;
+    if (spanTotal(ar) != 15 || spanTotal(car) != 15 || spanTotal(sa) != 15 || spanTotal(sm) != 15)
+        return false;
+    ustd::span<int> s(ar);
+    spanDouble(s.subspan(1, 2));  // 1 and 4
+    if (ar[1] != 2 || ar[2] != 8 || ar[0] != 5 || spanTotal(s) != 20)
+        return false;
+    if (spanTotal(s.first(2)) != 7 || spanTotal(s.last(2)) != 5 || s.first(10).length() != 5 ||
+        !s.subspan(5).isEmpty() || s.subspan(7, 3).length() != 0 || s.subspan(3).length() != 2)
+        return false;
+    ustd::sort(s);  // 2, 2, 3, 5, 8
+    if (ar[0] != 2 || ar[4] != 8 || ustd::binarySearch(ustd::span<const int>(ar), 5) != 3 ||
+        ustd::lowerBound(s, 4) != 3 || ustd::upperBound(s, 5) != 4)
+        return false;
+    if (ustd::indexOf(s, 8) != 4 || ustd::sum(ustd::span<const int>(table)) != 15 ||
+        ustd::maxValue(ustd::span<const int>(sa)) != 5 || ustd::count(s.first(3), 3) != 1)
+        return false;
+    map<int, int> mp;
+    mp[1] = 10;
+    mp[2] = 20;
+    ustd::span<const int> keys(mp.keysArray());
+    ustd::span<int> values(mp.values);
+    values[1] = 21;
+    return keys.length() == 2 && keys[1] == 2 && mp[2] == 21 && mp.keys.data() == keys.data();
+}
+
+struct calPoint {
+    int adc;
+    int temp;
+};
+const calPoint calibration[] USTD_FLASH = {{100, -200}, {300, 0}, {600, 250}, {900, 800}};
+const int primes[] USTD_FLASH = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31};
+
+bool calByAdc(const calPoint &p, const int &adc) {
+    return p.adc < adc;
+}
+
+bool adcByCal(const int &adc, const calPoint &p) {
+    return adc < p.adc;
+}
+
+bool checkFlashTable() {
+    ustd::flash_table<calPoint> cal(calibration);
+    ustd::flash_table<int> pt(primes);
+    if (cal.length() != 4 || cal[2].temp != 250 || pt.length() != 11 || pt[10] != 31)
+        return false;
+    int s = 0;
+    for (auto p : pt)
+        s += p;
+    if (s != 160 || pt.end() - pt.begin() != 11 || pt.begin()[3] != 7)
+        return false;
+    if (ustd::lowerBound(cal, 450, calByAdc) != 2 || ustd::lowerBound(cal, 1000, calByAdc) != 4 ||
+        ustd::upperBound(cal, 300, adcByCal) != 2)
+        return false;
+    if (ustd::binarySearch(pt, 13) != 5 || ustd::binarySearch(pt, 14) != -1 ||
+        ustd::lowerBound(pt, 1) != 0 || ustd::upperBound(pt, 31) != 11)
+        return false;
+    ustd::flash_table<int> part(primes + 2, 3);
+    return part[0] == 5 && part.length() == 3 && ustd::binarySearch(part, 11) == 2;
+}
+
+typedef ustd::shared_array<int, countingAllocator> sharedInts;
+
+unsigned int sharedUseCount(sharedInts byValue) {
+    return byValue.useCount();
+}
+
+bool checkSharedArray() {
+    allocStats st = {0, 0};
+    countingAllocator ca(&st);
+    {
+        sharedInts a(4, ARRAY_MAX_SIZE, 4, true, ustd::arrayGrowth(), ca);
+        const sharedInts &ra = a;
+        for (int i = 0; i < 10; i++)
+            a.add(i);
+        int blocks = st.blocks;
+        sharedInts b = a;
+        sharedInts c(a);
+        if (st.blocks != blocks || a.useCount() != 3 || !b.isShared() || sharedUseCount(a) != 4 ||
+            b.view().data() != ra.data() || ustd::sum(c.view()) != 45 || ra[9] != 9)
+            return false;
+        b[0] = 100;  // b detaches
+        if (st.blocks != blocks * 2 || a.useCount() != 2 || b.isShared() || ra[0] != 0 ||
+            b.view()[0] != 100)
+            return false;
+        if (c.add(10) != 10 || c.isShared() || a.isShared() || ra.length() != 10)
+            return false;
+        if (!b.reserve(10))  // a modification ends the validity of the reference from b[0]
+            return false;
+        c = b;  // the entries of the old c are freed
+        if (b.useCount() != 2 || st.blocks != blocks * 2)
+            return false;
+        sharedInts m(static_cast<sharedInts &&>(c));
+        if (m.useCount() != 2 || c.length() != 0 || !c.isEmpty() || c.begin() != c.end())
+            return false;
+        if (c.add(5) != 0 || c.length() != 1 || c.view()[0] != 5 || c.useCount() != 1)
+            return false;  // moved-from arrays can be reused
+        m = static_cast<sharedInts &&>(c);
+        if (m.length() != 1 || c.add(6) != 0 || c.length() != 1 || b.useCount() != 1)
+            return false;
+
+        // a reference taken from the sole owner must not leak into later copies
+        int &r = m[0];
+        sharedInts d(m);
+        sharedInts e = b;
+        e = m;
+        r = 99;
+        if (d.view()[0] != 5 || e.view()[0] != 5 || d.isShared() || m.view()[0] != 99)
+            return false;
+        if (!m.set(0, 7) || m.length() != 1)  // set() keeps copies O(1)
+            return false;
+        sharedInts f(m);
+        if (!f.isShared() || f.view()[0] != 7)
+            return false;
+        int total = 0;
+        for (auto v : ra)
+            total += v;
+        if (total != 45 || a.isShared())
+            return false;
+        ustd::shared_array<String> s;
+        s.add("a");
+        ustd::shared_array<String> t = s;
+        t[0] = "b";
+        t.add("c");
+        if (s.view()[0] != "a" || s.length() != 1 || t.length() != 2 || t.view()[1] != "c")
+            return false;
+    }
+    return st.blocks == 0 && st.bytes == 0;
+}
+
+bool checkSharedMap() {
+    ustd::shared_map<int, double> config;
+    config[1] = 1.5;
+    if (!config.set(2, 2.5))  // ends the validity of the reference from config[1]
+        return false;
+    ustd::shared_map<int, double> snap = config;
+    const ustd::shared_map<int, double> &rs = snap;
+    if (snap.useCount() != 2 || rs[1] != 1.5 || snap.get(2) != 2.5 || snap.find(3) != -1 ||
+        !snap.isShared())
+        return false;
+    config[1] = 3.0;  // config detaches
+    if (snap.isShared() || rs[1] != 1.5 || config.get(1) != 3.0)
+        return false;
+    ustd::shared_map<int, double> s2 = snap;
+    if (s2.erase(7) != -1 || !s2.isShared())  // missing key, no copy
+        return false;
+    if (s2.erase(1) != 0 || s2.isShared() || s2.length() != 1 || snap.length() != 2)
+        return false;
+    int ks = 0;
+    for (auto k : snap.keysArray())
+        ks += k;
+    double vs = 0;
+    for (auto v : snap.valuesArray())
+        vs += v;
+    if (ks != 3 || vs != 4.0 || snap.isEmpty())
+        return false;
+    double &v = snap[2];
+    ustd::shared_map<int, double> s3 = snap;
+    v = 9.0;
+    if (s3.get(2) != 2.5 || snap.get(2) != 9.0)
+        return false;
+    ustd::shared_map<int, double> moved(static_cast<ustd::shared_map<int, double> &&>(s3));
+    s3[4] = 4.0;  // moved-from maps can be reused
+    return s3.length() == 1 && s3.get(4) == 4.0 && moved.length() == 2;
+}
+
+bool checkChunkedArray() {
+    allocStats st = {0, 0};
+    countingAllocator ca(&st);
+    {
+        typedef ustd::chunked_array<int, 8, countingAllocator> chunkedInts;
+        chunkedInts ch(100, true, ca);
+        for (int i = 0; i < 20; i++)
+            ch.add(i);
+        int *p0 = &ch[0];
+        int *p19 = &ch[19];
+        for (int i = 20; i < 100; i++)
+            ch.add(i);
+        if (ch.add(100) != -1 || &ch[0] != p0 || &ch[19] != p19 || ch.length() != 100 ||
+            ch.chunks() != 13 || ch.alloclen() != 104 || chunkedInts::chunkSize() != 8)
+            return false;
+        int s = 0;
+        for (auto v : ch)
+            s += v;
+        const chunkedInts &rc = ch;
+        if (s != 4950 || rc[57] != 57 || *rc.begin() != 0)
+            return false;
+        chunkedInts cp(ch);
+        ch.erase(0);
+        if (ch[0] != 1 || ch[98] != 99 || cp[0] != 0 || cp.length() != 100)
+            return false;
+        while (ch.length() > 10)
+            ch.eraseUnordered(ch.length() - 1);
+        if (ch.chunks() != 3 || ch[9] != 10)  // 2 chunks in use, one spare
+            return false;
+        chunkedInts mv(static_cast<chunkedInts &&>(cp));
+        if (mv.length() != 100 || cp.length() != 0 || cp.begin() != cp.end())
+            return false;
+        cp = mv;
+        mv.erase();
+        if (mv.chunks() != 0 || cp[99] != 99 || !mv.isEmpty())
+            return false;
+        ustd::chunked_array<String, 2> str;
+        str[4] = "e";  // extends with empty strings
+        str.erase(1);
+        if (str.length() != 4 || str[3] != "e" || str[0] != "")
+            return false;
+    }
+    return st.blocks == 0 && st.bytes == 0;
+}
+
+bool checkSpscQueue() {
+    allocStats st = {0, 0};
+    countingAllocator ca(&st);
+    {
+        ustd::spsc_queue<int, countingAllocator> q(4, ca);
+        int v = 0;
+        if (!q.isEmpty() || q.pop(v) || q.front() != nullptr || q.capacity() != 4)
+            return false;
+        for (int i = 0; i < 4; i++)
+            q.push(i);
+        if (q.push(4) || q.length() != 4 || q.peak() != 4 || *q.front() != 0)
+            return false;
+        int s = 0;
+        for (int round = 0; round < 10; round++) {  // wrap around several times
+            if (!q.pop(v))
+                return false;
+            s += v;
+            q.push(round + 4);
+        }
+        if (q.length() != 4 || q.peak() != 4 || s != 45 || q.pop() != 10)
+            return false;
+        ustd::spsc_queue<String> sq(2);
+        sq.push("a");
+        sq.push(String("b"));
+        String r;
+        if (sq.push("c") || !sq.pop(r) || r != "a" || sq.pop() != "b" || sq.pop() != "")
+            return false;
+        sq.push("left");  // destroyed by the destructor
+    }
+    return st.blocks == 0 && st.bytes == 0;
+}
+
+bool checkMpmcQueue() {
+    allocStats st = {0, 0};
+    countingAllocator ca(&st);
+    {
+        ustd::mpmc_queue<int, countingAllocator> q(6, ca);  // rounded up to 8
+        int v = -1;
+        if (q.capacity() != 8 || !q.isEmpty() || q.tryPop(v) || v != -1)
+            return false;
+        int in[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+        if (!q.tryPush(in[0]) || q.tryPushN(in + 1, 9) != 7 || q.tryPush(8) || q.length() != 8 ||
+            q.peak() != 8)
+            return false;
+        int out[5];
+        if (q.tryPopN(out, 5) != 5 || out[0] != 0 || out[4] != 4 || q.length() != 3)
+            return false;
+        if (q.tryPushN(in + 8, 2) != 2 || q.tryPopN(out, 5) != 5 || out[2] != 7 || out[4] != 9)
+            return false;
+        if (q.tryPopN(out, 5) != 0 || q.pop() != 0 || q.peak() != 8)
+            return false;
+        ustd::mpmc_queue<String> sq(2);
+        sq.tryPush("a");
+        String r;
+        if (!sq.tryPop(r) || r != "a" || sq.tryPop(r))
+            return false;
+        sq.tryPush("left");  // destroyed by the destructor
+    }
+    return st.blocks == 0 && st.bytes == 0;
+}
+
+template <unsigned int N> bool checkQueueWrap() {
+    // wrap around several times, the queue holds at most fill entries
+    const unsigned int fill = N < 3 ? N : 3;
+    queue<String> q(N);
+    int next = 0, expect = 0;
+    for (int round = 0; round < 40; round++) {
+        while (q.length() < fill)
+            q.push(std::to_string(next++));
+        if (q.pop() != std::to_string(expect++))
+            return false;
+    }
+    int n = 0;
+    for (auto &e : q) {
+        if (e != std::to_string(expect + n))
+            return false;
+        ++n;
+    }
+    queue<String> cp(q);
+    if (n != (int)fill - 1 || cp.length() != fill - 1 || q.peak() != fill)
+        return false;
+    if (fill > 1 && cp.pop() != std::to_string(expect))
+        return false;
+    while (q.push("x")) {
+    }
+    if (q.length() != N || q.peak() != N || q.end() - q.begin() != (long)N)
+        return false;
+    while (!q.isEmpty())
+        q.pop();
+    return q.pop() == "" && q.length() == 0;
+}
+
+bool checkQueuePowerOfTwo() {
+    return checkQueueWrap<5>() && checkQueueWrap<8>() && checkQueueWrap<1>() &&
+           checkQueueWrap<2>();
+}
+
+template <unsigned int N> bool checkQueueBatchSize() {
+    // pushN/popN across the wrap, then UART-like I/O through the regions
+    queue<String> q(N);
+    String in[N + 2], out[N + 2];
+    for (unsigned int i = 0; i < N + 2; i++)
+        in[i] = std::to_string(i);
+    q.push("x");
+    q.push("y");
+    q.pop();
+    q.pop();  // read and write positions are now at 2
+    if (q.pushN(in, N + 2) != N || q.length() != N || q.peak() != N)
+        return false;
+    if (q.pushN(in, 1) != 0 || q.popN(out, 3) != 3)
+        return false;
+    if (out[0] != "0" || out[2] != "2" || q.pushN(in + N, 2) != 2)
+        return false;
+    unsigned int n = q.popN(out, N + 2);
+    if (n != N - 1 || out[0] != "3" || out[N - 2] != std::to_string(N + 1) || !q.isEmpty())
+        return false;
+
+    queue<unsigned char> bytes(N);
+    unsigned char msg[] = "abcdefghijklmnopqrstuvwxyz";
+    unsigned int sent = 0, received = 0;
+    ustd::span<unsigned char> a, b;
+    for (int round = 0; round < 10; round++) {
+        unsigned int free = bytes.writeRegions(a, b);
+        if (free != N - bytes.length() || a.length() + b.length() != free)
+            return false;
+        unsigned int w = a.length() < 3 ? a.length() : 3;  // short read() into a
+        for (unsigned int i = 0; i < w; i++)
+            a[i] = msg[(sent + i) % 26];
+        sent += w;
+        if (!bytes.commitWrite(w) || bytes.commitWrite(N + 1))
+            return false;
+        if (bytes.readRegions(a, b) != bytes.length() || a.length() + b.length() != bytes.length())
+            return false;
+        unsigned int r = a.length() < 2 ? a.length() : 2;  // short write() from a
+        for (unsigned int i = 0; i < r; i++) {
+            if (a[i] != msg[(received + i) % 26])
+                return false;
+        }
+        received += r;
+        if (!bytes.commitRead(r) || bytes.commitRead(N + 1))
+            return false;
+    }
+    return bytes.length() == sent - received;
+}
+
+bool checkQueueBatch() {
+    return checkQueueBatchSize<5>() && checkQueueBatchSize<8>();
+}
+
+template <unsigned int N> bool checkQueueOverwriteSize() {
+    // rolling window of the newest N entries
+    queue<String> q(N);
+    if (q.isOverwrite() || q.dropped() != 0)
+        return false;
+    for (unsigned int i = 0; i < N; i++)
+        q.push(std::to_string(i));
+    if (q.push("x") || q.dropped() != 0)
+        return false;
+    q.setOverwrite(true);
+    for (unsigned int i = N; i < 3 * N + 1; i++) {
+        if (!q.push(std::to_string(i)))
+            return false;
+    }
+    if (q.length() != N || q.peak() != N || q.dropped() != 2 * N + 1)
+        return false;
+    unsigned int expect = 2 * N + 1;
+    for (auto &e : q) {
+        if (e != std::to_string(expect++))
+            return false;
+    }
+    if (q.pop() != std::to_string(2 * N + 1))
+        return false;
+
+    // pushN drops the oldest entries, only the newest N of a larger batch are kept
+    String in[N + 2];
+    for (unsigned int i = 0; i < N + 2; i++)
+        in[i] = "b" + std::to_string(i);
+    q.resetDropped();
+    if (q.pushN(in, 2) != 2 || q.dropped() != 1 || q.length() != N)
+        return false;
+    if (q.pushN(in, N + 2) != N || q.dropped() != 1 + N + 2 || q.length() != N)
+        return false;
+    if (q.pop() != "b2" || q.pop() != "b3")
+        return false;
+    queue<String> copy(q);
+    return copy.dropped() == q.dropped() && copy.isOverwrite() && copy.length() == N - 2;
+}
+
+bool checkQueueOverwrite() {
+    return checkQueueOverwriteSize<5>() && checkQueueOverwriteSize<8>() &&
+           checkQueueOverwriteSize<2>();
+}
+
 int main() {
     cout << "Testing ustd..." << endl;
     cout << "Memory free is more than: " << freeMemory() << endl;
@@ -153,6 +1414,136 @@ int main() {
 
     constArrayInit();
 
+    if (!checkGrowth()) {
+        printf("Array growth policy test failed!\n");
+        aerr = true;
+    }
+
+    if (!checkLifetime()) {
+        printf("Array element lifetime test failed!\n");
+        aerr = true;
+    }
+
+    if (!checkTrivialPaths()) {
+        printf("Trivially copyable fast path test failed!\n");
+        aerr = true;
+    }
+
+    if (!checkSmallArray()) {
+        printf("Small array test failed!\n");
+        aerr = true;
+    }
+
+    if (!checkStaticArray()) {
+        printf("Static array test failed!\n");
+        aerr = true;
+    }
+
+    if (!checkRanges()) {
+        printf("Array range operation test failed!\n");
+        aerr = true;
+    }
+
+    if (!checkUnorderedErase()) {
+        printf("Unordered erase test failed!\n");
+        aerr = true;
+    }
+
+    if (!checkAlgorithms()) {
+        printf("Algorithm test failed!\n");
+        aerr = true;
+    }
+
+    if (!checkIterators()) {
+        printf("Iterator test failed!\n");
+        aerr = true;
+    }
+
+    if (!checkAllocator()) {
+        printf("Allocator test failed!\n");
+        aerr = true;
+    }
+
+    if (!checkArena()) {
+        printf("Arena allocator test failed!\n");
+        aerr = true;
+    }
+
+    if (!checkPool()) {
+        printf("Object pool test failed!\n");
+        aerr = true;
+    }
+
+    if (!checkSimd()) {
+        printf("SIMD kernel test failed!\n");
+        aerr = true;
+    }
+
+    if (!checkSoaArray()) {
+        printf("Structure-of-arrays test failed!\n");
+        aerr = true;
+    }
+
+    if (!checkBitarray()) {
+        printf("Bitarray test failed!\n");
+        aerr = true;
+    }
+
+    if (!checkSpan()) {
+        printf("Span test failed!\n");
+        aerr = true;
+    }
+
+    if (!checkFlashTable()) {
+        printf("Flash table test failed!\n");
+        aerr = true;
+    }
+
+    if (!checkSharedArray()) {
+        printf("Shared array test failed!\n");
+        aerr = true;
+    }
+
+    if (!checkSharedMap()) {
+        printf("Shared map test failed!\n");
+        aerr = true;
+    }
+
+    if (!checkChunkedArray()) {
+        printf("Chunked array test failed!\n");
+        aerr = true;
+    }
+
+    if (!checkSpscQueue()) {
+        printf("SPSC queue test failed!\n");
+        aerr = true;
+    }
+
+    if (!checkMpmcQueue()) {
+        printf("MPMC queue test failed!\n");
+        aerr = true;
+    }
+
+    if (!checkQueuePowerOfTwo()) {
+        printf("Queue power-of-two test failed!\n");
+        aerr = true;
+    }
+
+    if (!checkQueueBatch()) {
+        printf("Queue batch test failed!\n");
+        aerr = true;
+    }
+
+    if (!checkQueueOverwrite()) {
+        printf("Queue overwrite test failed!\n");
+        aerr = true;
+    }
+
+    if (!checkMove()) {
+        printf("Array move semantics test failed!\n");
+        aerr = true;
+    }
+
     bool qerr = false;
     if (!cpQue(qu, &qu))
         qerr = true;
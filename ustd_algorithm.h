@@ -0,0 +1,546 @@
+// ustd_algorithm.h - in-place algorithms for ustd arrays and raw ranges
+
+#pragma once
+
+#include "ustd_array.h"
+#include "ustd_span.h"
+#include "ustd_flash_table.h"
+
+/*! \file ustd_algorithm.h
+In-place, non-allocating algorithms for \ref ustd::array and raw ranges.
+
+ustd_algorithm.h provides sorting, searching and partitioning for platforms
+without <algorithm>. None of the algorithms allocate memory. All functions work
+on raw ranges [first, last) of type T*, and have overloads for
+\ref ustd::array. Comparators and predicates can be plain function pointers,
+lambdas, ustd::function<> or std::function<>. A comparator comp(a, b) returns
+true, if a must be sorted before b (strict weak ordering, like operator<).
+
+* * sort(): introsort, O(n log n) worst case, not stable.
+* * stableSort(): merge sort with a caller-provided buffer of n/2 entries.
+* * lowerBound(), upperBound(), binarySearch(): O(log n) lookups in sorted ranges.
+* * partition(): reorder by predicate, not stable.
+* * nthElement(): introselect, puts the n-th element in its sorted position.
+
+Make sure to provide the <a
+href="https://github.com/muwerk/ustd/blob/master/README.md">required platform
+define</a> before including ustd headers.
+
+## An example:
+
+~~~{.cpp}
+#define __UNO__ 1   // Platform defines required, see doc, mainpage.
+#include <ustd_algorithm.h>
+
+bool byValueDesc(const int &a, const int &b) {
+    return a > b;
+}
+
+ustd::array<int> ar;
+ar.add(3);
+ar.add(1);
+ar.add(2);
+ustd::sort(ar);                 // 1 2 3
+int i = ustd::binarySearch(ar, 2);   // 1
+ustd::sort(ar, byValueDesc);    // 3 2 1
+~~~
+*/
+
+#define USTD_SORT_THRESHOLD 16  // ranges up to this size are insertion sorted
+
+namespace ustd {
+
+template <typename T> struct lessThan {
+    /*! Default comparator, uses operator< of T */
+    bool operator()(const T &a, const T &b) const {
+        return a < b;
+    }
+};
+
+namespace details {
+
+template <typename T> inline void swapValues(T &a, T &b) {
+    T t(static_cast<T &&>(a));
+    a = static_cast<T &&>(b);
+    b = static_cast<T &&>(t);
+}
+
+template <typename T, typename Compare>
+void insertionSort(T *first, T *last, Compare &comp) {
+    if (first == last)
+        return;
+    for (T *i = first + 1; i < last; ++i) {
+        T v(static_cast<T &&>(*i));
+        T *j = i;
+        while (j > first && comp(v, *(j - 1))) {
+            *j = static_cast<T &&>(*(j - 1));
+            --j;
+        }
+        *j = static_cast<T &&>(v);
+    }
+}
+
+template <typename T, typename Compare>
+void siftDown(T *first, unsigned int root, unsigned int n, Compare &comp) {
+    while (true) {
+        unsigned int child = 2 * root + 1;
+        if (child >= n)
+            return;
+        if (child + 1 < n && comp(first[child], first[child + 1]))
+            ++child;
+        if (!comp(first[root], first[child]))
+            return;
+        swapValues(first[root], first[child]);
+        root = child;
+    }
+}
+
+template <typename T, typename Compare> void heapSort(T *first, T *last, Compare &comp) {
+    unsigned int n = last - first;
+    for (unsigned int i = n / 2; i > 0; i--)
+        siftDown(first, i - 1, n, comp);
+    for (unsigned int end = n; end > 1; end--) {
+        swapValues(first[0], first[end - 1]);
+        siftDown(first, 0, end - 1, comp);
+    }
+}
+
+template <typename T, typename Compare>
+T *partitionPivot(T *first, T *last, Compare &comp) {
+    // Move the median of first+1, mid, last-1 to first and partition the rest
+    // around it. The two other candidates act as sentinels for the scans.
+    T *a = first + 1, *b = first + (last - first) / 2, *c = last - 1;
+    if (comp(*a, *b)) {
+        if (comp(*b, *c))
+            swapValues(*first, *b);
+        else if (comp(*a, *c))
+            swapValues(*first, *c);
+        else
+            swapValues(*first, *a);
+    } else if (comp(*a, *c))
+        swapValues(*first, *a);
+    else if (comp(*b, *c))
+        swapValues(*first, *c);
+    else
+        swapValues(*first, *b);
+    T *lo = first + 1, *hi = last;
+    while (true) {
+        while (comp(*lo, *first))
+            ++lo;
+        --hi;
+        while (comp(*first, *hi))
+            --hi;
+        if (!(lo < hi))
+            return lo;
+        swapValues(*lo, *hi);
+        ++lo;
+    }
+}
+
+template <typename T, typename Compare>
+void introsortLoop(T *first, T *last, unsigned int depth, Compare &comp) {
+    while (last - first > USTD_SORT_THRESHOLD) {
+        if (depth == 0) {
+            heapSort(first, last, comp);
+            return;
+        }
+        --depth;
+        T *cut = partitionPivot(first, last, comp);
+        introsortLoop(cut, last, depth, comp);
+        last = cut;
+    }
+}
+
+inline unsigned int sortDepth(unsigned int n) {
+    unsigned int d = 0;
+    while (n > 1) {
+        n >>= 1;
+        d += 2;
+    }
+    return d;
+}
+
+template <typename T, typename Compare>
+void mergeSort(T *first, T *last, T *buffer, Compare &comp) {
+    unsigned int n = last - first;
+    if (n <= USTD_SORT_THRESHOLD) {
+        insertionSort(first, last, comp);
+        return;
+    }
+    T *mid = first + n / 2;
+    mergeSort(first, mid, buffer, comp);
+    mergeSort(mid, last, buffer, comp);
+    if (!comp(*mid, *(mid - 1)))
+        return;  // already in order
+    T *le = buffer;
+    for (T *p = first; p < mid; ++p, ++le)
+        *le = static_cast<T &&>(*p);
+    T *l = buffer, *r = mid, *out = first;
+    while (l < le && r < last) {
+        if (comp(*r, *l))
+            *out++ = static_cast<T &&>(*r++);
+        else
+            *out++ = static_cast<T &&>(*l++);
+    }
+    while (l < le)
+        *out++ = static_cast<T &&>(*l++);
+}
+
+}  // namespace details
+
+// ---- raw ranges ------------------------------------------------------------
+
+template <typename T, typename Compare> void sort(T *first, T *last, Compare comp) {
+    /*! Sort [first, last) with introsort, O(n log n), not stable.
+    @param first pointer to first element
+    @param last pointer behind the last element
+    @param comp comparator, comp(a, b) is true if a goes before b */
+    if (last - first < 2)
+        return;
+    details::introsortLoop(first, last, details::sortDepth(last - first), comp);
+    details::insertionSort(first, last, comp);
+}
+
+template <typename T> void sort(T *first, T *last) {
+    /*! Sort [first, last) ascending with operator<, see sort(first, last, comp) */
+    sort(first, last, lessThan<T>());
+}
+
+template <typename T, typename Compare>
+void stableSort(T *first, T *last, T *buffer, Compare comp) {
+    /*! Stable merge sort of [first, last), O(n log n), equal elements keep their
+    order. No memory is allocated.
+    @param first pointer to first element
+    @param last pointer behind the last element
+    @param buffer caller-provided scratch space of at least (last-first)/2
+    elements of type T
+    @param comp comparator, comp(a, b) is true if a goes before b */
+    details::mergeSort(first, last, buffer, comp);
+}
+
+template <typename T> void stableSort(T *first, T *last, T *buffer) {
+    /*! Stable ascending sort with operator<, see stableSort(first, last, buffer, comp) */
+    stableSort(first, last, buffer, lessThan<T>());
+}
+
+template <typename T, typename V, typename Compare>
+T *lowerBound(T *first, T *last, const V &value, Compare comp) {
+    /*! Find the first element in sorted [first, last) that is not before value.
+    @return pointer to the element, or last if all elements are before value */
+    unsigned int n = last - first;
+    while (n > 0) {
+        unsigned int half = n / 2;
+        if (comp(first[half], value)) {
+            first += half + 1;
+            n -= half + 1;
+        } else {
+            n = half;
+        }
+    }
+    return first;
+}
+
+template <typename T, typename V> T *lowerBound(T *first, T *last, const V &value) {
+    /*! lowerBound() with operator< */
+    return lowerBound(first, last, value, lessThan<T>());
+}
+
+template <typename T, typename V, typename Compare>
+T *upperBound(T *first, T *last, const V &value, Compare comp) {
+    /*! Find the first element in sorted [first, last) that goes after value.
+    @return pointer to the element, or last if no element goes after value */
+    unsigned int n = last - first;
+    while (n > 0) {
+        unsigned int half = n / 2;
+        if (!comp(value, first[half])) {
+            first += half + 1;
+            n -= half + 1;
+        } else {
+            n = half;
+        }
+    }
+    return first;
+}
+
+template <typename T, typename V> T *upperBound(T *first, T *last, const V &value) {
+    /*! upperBound() with operator< */
+    return upperBound(first, last, value, lessThan<T>());
+}
+
+template <typename T, typename Predicate> T *partition(T *first, T *last, Predicate pred) {
+    /*! Reorder [first, last) so that all elements for which pred is true come
+    first, not stable.
+    @return pointer to the first element for which pred is false */
+    while (true) {
+        while (first != last && pred(*first))
+            ++first;
+        if (first == last)
+            return first;
+        do {
+            --last;
+            if (first == last)
+                return first;
+        } while (!pred(*last));
+        details::swapValues(*first, *last);
+        ++first;
+    }
+}
+
+template <typename T, typename Compare> void nthElement(T *first, T *nth, T *last, Compare comp) {
+    /*! Reorder [first, last) so that nth holds the element that would be there
+    if the range was sorted, no element before nth goes after it, and no element
+    after nth goes before it. Average O(n).
+    @param first pointer to first element
+    @param nth pointer to the element to be placed
+    @param last pointer behind the last element
+    @param comp comparator, comp(a, b) is true if a goes before b */
+    if (nth >= last)
+        return;
+    unsigned int depth = details::sortDepth(last - first);
+    while (last - first > 3) {
+        if (depth == 0) {
+            details::heapSort(first, last, comp);
+            return;
+        }
+        --depth;
+        T *cut = details::partitionPivot(first, last, comp);
+        if (cut <= nth)
+            first = cut;
+        else
+            last = cut;
+    }
+    details::insertionSort(first, last, comp);
+}
+
+template <typename T> void nthElement(T *first, T *nth, T *last) {
+    /*! nthElement() with operator< */
+    nthElement(first, nth, last, lessThan<T>());
+}
+
+// ---- ustd::array -----------------------------------------------------------
+
+template <typename T, typename A, typename Compare> void sort(array<T, A> &ar, Compare comp) {
+    /*! Sort array with introsort, see sort(first, last, comp) */
+    sort(ar.data(), ar.data() + ar.length(), comp);
+}
+
+template <typename T, typename A> void sort(array<T, A> &ar) {
+    /*! Sort array ascending with operator< */
+    sort(ar.data(), ar.data() + ar.length(), lessThan<T>());
+}
+
+template <typename T, typename A, typename Compare>
+void stableSort(array<T, A> &ar, T *buffer, Compare comp) {
+    /*! Stable sort of array, see stableSort(first, last, buffer, comp)
+    @param ar array to sort
+    @param buffer scratch space of at least ar.length()/2 elements
+    @param comp comparator */
+    stableSort(ar.data(), ar.data() + ar.length(), buffer, comp);
+}
+
+template <typename T, typename A> void stableSort(array<T, A> &ar, T *buffer) {
+    /*! Stable ascending sort of array with operator< */
+    stableSort(ar.data(), ar.data() + ar.length(), buffer, lessThan<T>());
+}
+
+template <typename T, typename A, typename V, typename Compare>
+unsigned int lowerBound(const array<T, A> &ar, const V &value, Compare comp) {
+    /*! Index of the first entry of sorted array ar that is not before value
+    @return index, or ar.length() if all entries are before value */
+    return lowerBound(ar.data(), ar.data() + ar.length(), value, comp) - ar.data();
+}
+
+template <typename T, typename A> unsigned int lowerBound(const array<T, A> &ar, const T &value) {
+    /*! lowerBound() with operator< */
+    return lowerBound(ar, value, lessThan<T>());
+}
+
+template <typename T, typename A, typename V, typename Compare>
+unsigned int upperBound(const array<T, A> &ar, const V &value, Compare comp) {
+    /*! Index of the first entry of sorted array ar that goes after value
+    @return index, or ar.length() if no entry goes after value */
+    return upperBound(ar.data(), ar.data() + ar.length(), value, comp) - ar.data();
+}
+
+template <typename T, typename A> unsigned int upperBound(const array<T, A> &ar, const T &value) {
+    /*! upperBound() with operator< */
+    return upperBound(ar, value, lessThan<T>());
+}
+
+template <typename T, typename A, typename V, typename Compare>
+int binarySearch(const array<T, A> &ar, const V &value, Compare comp) {
+    /*! Find value in the sorted array ar in O(log n)
+    @return index of an entry equivalent to value, or -1 if not found */
+    unsigned int i = lowerBound(ar, value, comp);
+    if (i < ar.length() && !comp(value, ar.data()[i]))
+        return (int)i;
+    return -1;
+}
+
+template <typename T, typename A> int binarySearch(const array<T, A> &ar, const T &value) {
+    /*! binarySearch() with operator< */
+    return binarySearch(ar, value, lessThan<T>());
+}
+
+template <typename T, typename A, typename Predicate>
+unsigned int partition(array<T, A> &ar, Predicate pred) {
+    /*! Reorder array so that all entries for which pred is true come first
+    @return index of the first entry for which pred is false */
+    return partition(ar.data(), ar.data() + ar.length(), pred) - ar.data();
+}
+
+template <typename T, typename A, typename Compare>
+void nthElement(array<T, A> &ar, unsigned int nth, Compare comp) {
+    /*! Put the entry that belongs to index nth in sorted order at index nth,
+    see nthElement(first, nth, last, comp) */
+    nthElement(ar.data(), ar.data() + nth, ar.data() + ar.length(), comp);
+}
+
+template <typename T, typename A> void nthElement(array<T, A> &ar, unsigned int nth) {
+    /*! nthElement() with operator< */
+    nthElement(ar.data(), ar.data() + nth, ar.data() + ar.length(), lessThan<T>());
+}
+
+// ---- ustd::span ------------------------------------------------------------
+
+template <typename T, typename Compare> void sort(span<T> s, Compare comp) {
+    /*! Sort the entries of view s with introsort, see sort(first, last, comp) */
+    sort(s.begin(), s.end(), comp);
+}
+
+template <typename T> void sort(span<T> s) {
+    /*! Sort the entries of view s ascending with operator< */
+    sort(s.begin(), s.end(), lessThan<T>());
+}
+
+template <typename T, typename Compare> void stableSort(span<T> s, T *buffer, Compare comp) {
+    /*! Stable sort of view s, buffer needs s.length()/2 elements */
+    stableSort(s.begin(), s.end(), buffer, comp);
+}
+
+template <typename T> void stableSort(span<T> s, T *buffer) {
+    /*! Stable ascending sort of view s with operator< */
+    stableSort(s.begin(), s.end(), buffer, lessThan<T>());
+}
+
+template <typename T, typename V, typename Compare>
+unsigned int lowerBound(span<T> s, const V &value, Compare comp) {
+    /*! Index of the first entry of sorted view s that is not before value
+    @return index, or s.length() if all entries are before value */
+    return lowerBound(s.begin(), s.end(), value, comp) - s.begin();
+}
+
+template <typename T, typename V> unsigned int lowerBound(span<T> s, const V &value) {
+    /*! lowerBound() with operator< */
+    return lowerBound(s, value, lessThan<typename details::removeConst<T>::type>());
+}
+
+template <typename T, typename V, typename Compare>
+unsigned int upperBound(span<T> s, const V &value, Compare comp) {
+    /*! Index of the first entry of sorted view s that goes after value
+    @return index, or s.length() if no entry goes after value */
+    return upperBound(s.begin(), s.end(), value, comp) - s.begin();
+}
+
+template <typename T, typename V> unsigned int upperBound(span<T> s, const V &value) {
+    /*! upperBound() with operator< */
+    return upperBound(s, value, lessThan<typename details::removeConst<T>::type>());
+}
+
+template <typename T, typename V, typename Compare>
+int binarySearch(span<T> s, const V &value, Compare comp) {
+    /*! Find value in the sorted view s in O(log n)
+    @return index of an entry equivalent to value, or -1 if not found */
+    unsigned int i = lowerBound(s, value, comp);
+    if (i < s.length() && !comp(value, s[i]))
+        return (int)i;
+    return -1;
+}
+
+template <typename T, typename V> int binarySearch(span<T> s, const V &value) {
+    /*! binarySearch() with operator< */
+    return binarySearch(s, value, lessThan<typename details::removeConst<T>::type>());
+}
+
+template <typename T, typename Predicate> unsigned int partition(span<T> s, Predicate pred) {
+    /*! Reorder view s so that all entries for which pred is true come first
+    @return index of the first entry for which pred is false */
+    return partition(s.begin(), s.end(), pred) - s.begin();
+}
+
+template <typename T, typename Compare>
+void nthElement(span<T> s, unsigned int nth, Compare comp) {
+    /*! Put the entry that belongs to index nth in sorted order at index nth */
+    nthElement(s.begin(), s.begin() + nth, s.end(), comp);
+}
+
+template <typename T> void nthElement(span<T> s, unsigned int nth) {
+    /*! nthElement() with operator< */
+    nthElement(s.begin(), s.begin() + nth, s.end(), lessThan<T>());
+}
+
+// ---- ustd::flash_table -----------------------------------------------------
+
+template <typename T, typename V, typename Compare>
+unsigned int lowerBound(const flash_table<T> &t, const V &value, Compare comp) {
+    /*! Index of the first entry of sorted flash table t that is not before
+    value, entries are read from flash one at a time
+    @return index, or t.length() if all entries are before value */
+    unsigned int first = 0;
+    unsigned int n = t.length();
+    while (n > 0) {
+        unsigned int half = n / 2;
+        if (comp(t[first + half], value)) {
+            first += half + 1;
+            n -= half + 1;
+        } else {
+            n = half;
+        }
+    }
+    return first;
+}
+
+template <typename T> unsigned int lowerBound(const flash_table<T> &t, const T &value) {
+    /*! lowerBound() with operator< */
+    return lowerBound(t, value, lessThan<T>());
+}
+
+template <typename T, typename V, typename Compare>
+unsigned int upperBound(const flash_table<T> &t, const V &value, Compare comp) {
+    /*! Index of the first entry of sorted flash table t that goes after value
+    @return index, or t.length() if no entry goes after value */
+    unsigned int first = 0;
+    unsigned int n = t.length();
+    while (n > 0) {
+        unsigned int half = n / 2;
+        if (!comp(value, t[first + half])) {
+            first += half + 1;
+            n -= half + 1;
+        } else {
+            n = half;
+        }
+    }
+    return first;
+}
+
+template <typename T> unsigned int upperBound(const flash_table<T> &t, const T &value) {
+    /*! upperBound() with operator< */
+    return upperBound(t, value, lessThan<T>());
+}
+
+template <typename T, typename V, typename Compare>
+int binarySearch(const flash_table<T> &t, const V &value, Compare comp) {
+    /*! Find value in the sorted flash table t in O(log n)
+    @return index of an entry equivalent to value, or -1 if not found */
+    unsigned int i = lowerBound(t, value, comp);
+    if (i < t.length() && !comp(value, t[i]))
+        return (int)i;
+    return -1;
+}
+
+template <typename T> int binarySearch(const flash_table<T> &t, const T &value) {
+    /*! binarySearch() with operator< */
+    return binarySearch(t, value, lessThan<T>());
+}
+
+}  // namespace ustd
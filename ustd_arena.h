@@ -0,0 +1,281 @@
+// ustd_arena.h - bump allocator for short-lived containers
+
+#pragma once
+
+#include "ustd_memory.h"
+
+#ifndef ARENA_ALIGN
+#define ARENA_ALIGN alignof(long double)  // alignment of each arena allocation
+#endif
+
+namespace ustd {
+
+/*! \brief Bump allocator with O(1) allocation and whole-arena reset.
+
+ustd_arena.h provides a region allocator for objects with a common lifetime,
+e.g. the arrays and maps that are created while processing a single message.
+All allocations come from one fixed buffer: allocating just moves a pointer,
+and reset() (or an \ref ustd::arenaScope) releases everything at once. Since
+the buffer itself never changes, this avoids heap fragmentation.
+
+Freeing or growing the most recent allocation is done in place, so an array
+that grows with add() reallocates without copying, as long as it is the last
+object that allocated from the arena. Other deallocations are ignored, their
+memory is reclaimed on reset().
+
+Containers use the arena via \ref ustd::arenaAllocator. All containers that
+allocate from an arena must be destroyed before the arena is reset or rewound.
+
+Make sure to provide the <a
+href="https://github.com/muwerk/ustd/blob/master/README.md">required platform
+define</a> before including ustd headers.
+
+## An example:
+
+~~~{.cpp}
+#define __ESP__ 1   // Platform defines required, see doc, mainpage.
+#include <ustd_arena.h>
+
+ustd::arena msgArena(2048);  // one allocation at startup
+
+void onMessage(const char *msg) {
+    ustd::arenaScope scope(msgArena);  // everything is released at the end of the scope
+    ustd::array<int, ustd::arenaAllocator> tokens(8, ARRAY_MAX_SIZE, 8, true,
+                                                  ustd::arrayGrowth(),
+                                                  ustd::arenaAllocator(msgArena));
+    ...
+}
+
+printf("arena peak: %u of %u bytes\n", msgArena.peak(), msgArena.capacity());
+~~~
+ */
+class arena {
+  private:
+    unsigned char *buf;
+    size_t bufSize;
+    size_t top;
+    size_t lastTop;  // top before the most recent allocation
+    size_t peakSize;
+    unsigned int failCount;
+    bool owned;
+
+    size_t alignUp(size_t offset) const {
+        // align the absolute address, so that external buffers work too
+        size_t addr = (size_t)(buf + offset);
+        size_t pad = (ARENA_ALIGN - addr % ARENA_ALIGN) % ARENA_ALIGN;
+        return offset + pad;
+    }
+
+    bool isLast(void *p) const {
+        return p != nullptr && (unsigned char *)p == buf + alignUp(lastTop) && lastTop < top;
+    }
+
+  public:
+    explicit arena(size_t size)
+        : bufSize(size), top(0), lastTop(0), peakSize(0), failCount(0), owned(true) {
+        /*! Constructs an arena and allocates its buffer of size bytes from the
+        heap. This is the only heap allocation of the arena.
+        @param size arena size in bytes, check capacity() for allocation failure */
+        buf = (unsigned char *)malloc(size);
+        if (buf == nullptr)
+            bufSize = 0;
+    }
+
+    arena(void *buffer, size_t size)
+        : buf((unsigned char *)buffer), bufSize(size), top(0), lastTop(0), peakSize(0),
+          failCount(0), owned(false) {
+        /*! Constructs an arena on an existing buffer, e.g. a static array, no
+        heap memory is used.
+        @param buffer memory of the arena, must outlive the arena
+        @param size size of buffer in bytes */
+    }
+
+    arena(const arena &) = delete;
+    arena &operator=(const arena &) = delete;
+
+    ~arena() {
+        /*! Free the arena buffer, if it was allocated by the arena */
+        if (owned && buf != nullptr)
+            free(buf);
+    }
+
+    void *allocate(size_t bytes) {
+        /*! Allocate bytes of memory in O(1), aligned to ARENA_ALIGN
+        @return pointer to memory or nullptr, if the arena is exhausted */
+        size_t start = alignUp(top);
+        if (start > bufSize || bytes > bufSize - start) {
+            ++failCount;
+            return nullptr;
+        }
+        lastTop = top;
+        top = start + bytes;
+        if (top > peakSize)
+            peakSize = top;
+        return buf + start;
+    }
+
+    void deallocate(void *p, size_t) {
+        /*! Release memory p. Only the most recent allocation is returned to the
+        arena immediately, all other memory is reclaimed by reset(). */
+        if (isLast(p)) {
+            top = lastTop;
+        }
+    }
+
+    void *reallocate(void *p, size_t oldBytes, size_t newBytes) {
+        /*! Resize memory block p (may be nullptr) from oldBytes to newBytes.
+        The most recent allocation is resized in place, other blocks are copied
+        when growing.
+        @return pointer to the resized block or nullptr (p is untouched) */
+        if (p == nullptr)
+            return allocate(newBytes);
+        if (isLast(p)) {
+            size_t start = (unsigned char *)p - buf;
+            if (newBytes > bufSize - start) {
+                ++failCount;
+                return nullptr;
+            }
+            top = start + newBytes;
+            if (top > peakSize)
+                peakSize = top;
+            return p;
+        }
+        if (newBytes <= oldBytes)
+            return p;  // shrinking keeps the block, the tail is reclaimed on reset()
+        void *pn = allocate(newBytes);
+        if (pn != nullptr)
+            memcpy(pn, p, oldBytes < newBytes ? oldBytes : newBytes);
+        return pn;
+    }
+
+    void reset() {
+        /*! Release all allocations at once. All objects using arena memory
+        must have been destroyed. */
+        top = 0;
+        lastTop = 0;
+    }
+
+    size_t mark() const {
+        /*! Current fill level, used with rewind() to release all allocations
+        made after mark() was called, see \ref ustd::arenaScope.
+        @return opaque marker */
+        return top;
+    }
+
+    void rewind(size_t marker) {
+        /*! Release all allocations made after marker was obtained with mark()
+        @param marker fill level returned by mark() */
+        if (marker < top) {
+            top = marker;
+            lastTop = marker;
+        }
+    }
+
+    size_t used() const {
+        /*! Number of bytes currently allocated, including alignment padding
+        @return bytes in use */
+        return top;
+    }
+
+    size_t available() const {
+        /*! Number of bytes left in the arena
+        @return free bytes */
+        return bufSize - top;
+    }
+
+    size_t capacity() const {
+        /*! Size of the arena buffer
+        @return capacity in bytes, 0 if the buffer could not be allocated */
+        return bufSize;
+    }
+
+    size_t peak() const {
+        /*! High-water mark: the maximum number of bytes that were in use at
+        the same time, useful to size the arena.
+        @return peak usage in bytes */
+        return peakSize;
+    }
+
+    unsigned int failures() const {
+        /*! Number of allocations that failed because the arena was exhausted
+        @return number of failed allocations */
+        return failCount;
+    }
+
+    void resetStats() {
+        /*! Restart peak() at the current usage and clear failures() */
+        peakSize = top;
+        failCount = 0;
+    }
+};
+
+/*! \brief Scope guard that releases all arena allocations of a scope.
+
+On construction the current fill level of the arena is recorded, the destructor
+rewinds the arena to that level. Containers that use the arena must be declared
+after the guard, so that they are destroyed before it.
+
+~~~{.cpp}
+{
+    ustd::arenaScope scope(myArena);
+    ustd::map<int, int, ustd::arenaAllocator> m(8, ARRAY_MAX_SIZE, 8, true,
+                                               ustd::arrayGrowth(), ustd::arenaAllocator(myArena));
+    ...
+}  // m is destroyed, then all memory of the scope returns to myArena
+~~~
+ */
+class arenaScope {
+  private:
+    arena &ar;
+    size_t marker;
+
+  public:
+    explicit arenaScope(arena &ar) : ar(ar), marker(ar.mark()) {
+        /*! Record the fill level of arena ar */
+    }
+
+    arenaScope(const arenaScope &) = delete;
+    arenaScope &operator=(const arenaScope &) = delete;
+
+    ~arenaScope() {
+        /*! Release all allocations made during the lifetime of the guard */
+        ar.rewind(marker);
+    }
+};
+
+/*! \brief Allocator adapter to use an \ref ustd::arena with ustd containers.
+
+The adapter only holds a pointer to the arena, so containers can copy it
+cheaply, see \ref ustd::mallocAllocator for the allocator interface.
+
+~~~{.cpp}
+ustd::queue<int, ustd::arenaAllocator> que(16, ustd::arenaAllocator(myArena));
+~~~
+ */
+class arenaAllocator {
+  private:
+    arena *ar;
+
+  public:
+    arenaAllocator(arena &ar) : ar(&ar) {
+        /*! Construct an allocator for arena ar, ar must outlive all containers
+        that use the allocator. */
+    }
+
+    void *allocate(size_t bytes) {
+        /*! Allocate bytes from the arena, see \ref ustd::arena::allocate() */
+        return ar->allocate(bytes);
+    }
+
+    void deallocate(void *p, size_t bytes) {
+        /*! Release p, see \ref ustd::arena::deallocate() */
+        ar->deallocate(p, bytes);
+    }
+
+    void *reallocate(void *p, size_t oldBytes, size_t newBytes) {
+        /*! Resize p, see \ref ustd::arena::reallocate() */
+        return ar->reallocate(p, oldBytes, newBytes);
+    }
+};
+
+}  // namespace ustd
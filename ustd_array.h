@@ -8,7 +8,17 @@
 ustd provides minimal and highly portable implementations of the following classes:
 
 * * \ref ustd::array<T>, a lightweight c++11 array implementation.
+* * \ref ustd::small_array<T,N>, an array with inline storage for the first N entries.
+* * \ref ustd::static_array<T,N>, an array with compile-time capacity and no heap usage.
+* * \ref ustd::soa_array<Ts...>, a structure-of-arrays container with one column per field.
+* * \ref ustd::bitarray, a bit-packed dynamic bitset.
+* * \ref ustd::span<T>, a non-owning view of contiguous entries.
+* * \ref ustd::flash_table<T>, a read-only view of constant tables in flash (PROGMEM).
+* * \ref ustd::shared_array<T> and \ref ustd::shared_map<K,V>, copy-on-write containers with O(1) copies.
+* * \ref ustd::chunked_array<T,N>, a segmented array with stable element addresses.
 * * \ref ustd::queue<T>, a lightweight c++11 ring buffer queue implementation.
+* * \ref ustd::spsc_queue<T>, a wait-free single-producer/single-consumer queue.
+* * \ref ustd::mpmc_queue<T>, a bounded lock-free multi-producer/multi-consumer queue.
 * * \ref ustd::map<K,V>, a lightweight c++11 dictionary map implementation.
 
 Additionally a drop-in replacement for `std::function<>` is provided as
@@ -16,6 +26,15 @@ Additionally a drop-in replacement for `std::function<>` is provided as
 
 * * \ref functional.h
 
+Allocation-free sort, search and partition algorithms are in
+
+* * \ref ustd_algorithm.h
+* * \ref ustd_simd.h (vectorized search, count, min, max and sum)
+
+\ref ustd::arena is a bump allocator for short-lived containers and
+\ref ustd::pool a fixed-block object pool, see \ref ustd::mallocAllocator for
+the allocator interface of the containers.
+
 The libraries are header-only and should work with any c++11 compiler
 and support platforms starting with 8k attiny, avr, arduinos, up to esp8266,
 esp32 and mac and linux.
@@ -29,6 +48,7 @@ define</a> before including ustd headers.
 */
 
 #include "ustd_platform.h"
+#include "ustd_memory.h"
 
 //! \brief The ustd namespace
 namespace ustd {
@@ -37,6 +57,82 @@ namespace ustd {
 #define ARRAY_MAX_SIZE UINT_MAX  // 65535 or 4294967295 (mostly)
 #define ARRAY_INIT_SIZE 16
 
+#define ARRAY_GROW_LINEAR 0     // grow by incSize entries (default)
+#define ARRAY_GROW_GEOMETRIC 1  // grow by a factor of the current allocation
+#define ARRAY_GROW_CAPPED 2     // geometric, but never more than a cap entries at once
+#define ARRAY_GROWTH_FACTOR 200  // default geometric factor in percent (2x)
+
+/*! \brief Growth policy for \ref ustd::array and \ref ustd::map
+
+The growth policy decides how many entries are allocated if an array needs to
+grow and when memory is given back on erase(). incSize of the array is always the
+minimum step, and an incSize of 0 still means that the array never grows.
+
+* * linear() is the classic ustd behaviour: grow by incSize entries. Cheap on
+memory, but appending n entries costs O(n²/incSize) copies.
+* * geometric(factor) grows the allocation by factor percent (e.g. 150 or 200),
+which makes add() amortized O(1).
+* * capped(factor, cap) grows geometrically, but never by more than cap entries at
+once, useful for MCUs where a single large allocation would fail.
+
+~~~{.cpp}
+ustd::array<int> ar(16, ARRAY_MAX_SIZE, 16, true, ustd::arrayGrowth::geometric(150));
+ustd::map<int, int> mp(16, 4096, 16, true, ustd::arrayGrowth::capped(200, 256));
+~~~
+*/
+class arrayGrowth {
+  public:
+    unsigned char mode;  /*! One of ARRAY_GROW_LINEAR, _GEOMETRIC or _CAPPED */
+    unsigned int factor; /*! Growth factor in percent, must be > 100 for geometric modes */
+    unsigned int cap;    /*! Maximum number of entries added by one growth step (_CAPPED) */
+
+    arrayGrowth(unsigned char mode = ARRAY_GROW_LINEAR, unsigned int factor = ARRAY_GROWTH_FACTOR,
+                unsigned int cap = 0)
+        : mode(mode), factor(factor), cap(cap) {
+    }
+
+    static arrayGrowth linear() {
+        /*! Grow by incSize entries (default) */
+        return arrayGrowth(ARRAY_GROW_LINEAR);
+    }
+
+    static arrayGrowth geometric(unsigned int factor = ARRAY_GROWTH_FACTOR) {
+        /*! Grow by factor percent of the current allocation
+        @param factor growth factor in percent, e.g. 200 doubles the allocation */
+        return arrayGrowth(ARRAY_GROW_GEOMETRIC, factor);
+    }
+
+    static arrayGrowth capped(unsigned int factor, unsigned int cap) {
+        /*! Grow by factor percent, but by at most cap entries per step
+        @param factor growth factor in percent
+        @param cap maximum number of entries that are added by one growth step */
+        return arrayGrowth(ARRAY_GROW_CAPPED, factor, cap);
+    }
+
+    unsigned int next(unsigned int cur, unsigned int incSize, unsigned int maxSize) const {
+        /*! Calculate the allocation size that follows cur
+        @param cur current allocation size
+        @param incSize minimum number of entries to add, 0: no growth
+        @param maxSize upper limit for the result
+        @return new allocation size, at most maxSize */
+        if (incSize == 0)
+            return cur;
+        unsigned long inc = incSize;
+        if (mode != ARRAY_GROW_LINEAR && factor > 100) {
+            // split, so that cur * factor cannot overflow with 32 bit longs
+            unsigned long geo =
+                (unsigned long)(cur / 100) * (factor - 100) + cur % 100 * (factor - 100) / 100;
+            if (mode == ARRAY_GROW_CAPPED && cap && geo > cap)
+                geo = cap;
+            if (geo > inc)
+                inc = geo;
+        }
+        if (cur >= maxSize || inc >= maxSize - cur)
+            return maxSize;
+        return cur + (unsigned int)inc;
+    }
+};
+
 // Helper class for array iterators:
 template <typename T> class arrayIterator {
   private:
@@ -44,9 +140,31 @@ template <typename T> class arrayIterator {
     unsigned int position;
 
   public:
+    typedef typename details::removeConst<T>::type value_type;
+    typedef long difference_type;
+    typedef T *pointer;
+    typedef T &reference;
+
+    arrayIterator() : values_ptr{nullptr}, position{0} {
+    }
+
     arrayIterator(T *values_ptr, unsigned int p) : values_ptr{values_ptr}, position{p} {
     }
 
+    template <typename U>
+    arrayIterator(const arrayIterator<U> &other)
+        : values_ptr{other.base()}, position{other.index()} {
+        // conversion from iterator to const_iterator
+    }
+
+    T *base() const {
+        return values_ptr;
+    }
+
+    unsigned int index() const {
+        return position;
+    }
+
     bool operator!=(const arrayIterator<T> &other) const {
         return !(*this == other);
     }
@@ -55,14 +173,81 @@ template <typename T> class arrayIterator {
         return position == other.position;
     }
 
+    bool operator<(const arrayIterator<T> &other) const {
+        return position < other.position;
+    }
+
+    bool operator>(const arrayIterator<T> &other) const {
+        return position > other.position;
+    }
+
+    bool operator<=(const arrayIterator<T> &other) const {
+        return position <= other.position;
+    }
+
+    bool operator>=(const arrayIterator<T> &other) const {
+        return position >= other.position;
+    }
+
     arrayIterator &operator++() {
         ++position;
         return *this;
     }
 
+    arrayIterator operator++(int) {
+        arrayIterator it(*this);
+        ++position;
+        return it;
+    }
+
+    arrayIterator &operator--() {
+        --position;
+        return *this;
+    }
+
+    arrayIterator operator--(int) {
+        arrayIterator it(*this);
+        --position;
+        return it;
+    }
+
+    arrayIterator &operator+=(difference_type n) {
+        position += n;
+        return *this;
+    }
+
+    arrayIterator &operator-=(difference_type n) {
+        position -= n;
+        return *this;
+    }
+
+    arrayIterator operator+(difference_type n) const {
+        return arrayIterator(values_ptr, position + n);
+    }
+
+    friend arrayIterator operator+(difference_type n, const arrayIterator &it) {
+        return it + n;
+    }
+
+    arrayIterator operator-(difference_type n) const {
+        return arrayIterator(values_ptr, position - n);
+    }
+
+    difference_type operator-(const arrayIterator<T> &other) const {
+        return (difference_type)position - (difference_type)other.position;
+    }
+
     T &operator*() const {
         return *(values_ptr + position);
     }
+
+    T *operator->() const {
+        return values_ptr + position;
+    }
+
+    T &operator[](difference_type n) const {
+        return *(values_ptr + position + n);
+    }
 };
 
 /*! \brief Lightweight c++11 array implementation.
@@ -104,7 +289,30 @@ printf("[0]:%d [1]:%d length=%d\n", intArray[0], intArray[1], intArray.length())
 #include <ustd_array.h>
 
 // array length is fixed 5 (startSize==maxSize), no dynamic extensions:
-ustd::array<int> intArray = ustd::array<int>(5, 5, 0, false);d
+ustd::array<int> intArray = ustd::array<int>(5, 5, 0, false);
+~~~
+
+Static mode still allocates the 5 entries on the heap during construction, use
+\ref ustd::static_array for arrays without any heap usage.
+
+## Growth policy
+
+By default the array grows by incSize entries. For large arrays that are filled
+with add() a geometric growth policy avoids quadratic copying, see
+\ref ustd::arrayGrowth:
+
+~~~{.cpp}
+ustd::array<int> samples(16, ARRAY_MAX_SIZE, 16, true, ustd::arrayGrowth::geometric());
+~~~
+
+## Allocators
+
+The memory of the array is requested from the allocator given as second
+template parameter, by default \ref ustd::mallocAllocator. Custom allocators
+can place arrays in a dedicated memory region:
+
+~~~{.cpp}
+ustd::array<int, myAllocator> ar(16, ARRAY_MAX_SIZE, 16, true, ustd::arrayGrowth(), myAllocator());
 ~~~
 
 ## Iterators and initializing with const T[] c-arrays:
@@ -120,7 +328,7 @@ for (auto i : ia) {
 ~~~
 
  */
-template <typename T> class array {
+template <typename T, typename Alloc = mallocAllocator> class array {
 
   private:
     T *arr;
@@ -128,29 +336,46 @@ template <typename T> class array {
     unsigned int maxSize;
     unsigned int incSize = ARRAY_INC_SIZE;
     bool shrink = true;
+    arrayGrowth growth;
     unsigned int allocSize;
     unsigned int size;
     T bad = {};
+    Alloc alloc;
 
+    // Raw, uninitialized storage: only the first size entries are constructed.
     T *ualloc(unsigned int n) {
-#if defined(__ATTINY__)
-        return (T *)malloc(n * sizeof(T));
-#else
-        return new T[n];
-#endif
+        return (T *)alloc.allocate(n * sizeof(T));
     }
-    void ufree(T *p) {
-#if defined(__ATTINY__)
-        free(p);
-#else
-        delete[] p;
-#endif
+    void ufree(T *p, unsigned int n) {
+        alloc.deallocate(p, n * sizeof(T));
+    }
+
+    bool reserveOne() {
+        if (size < allocSize)
+            return true;
+        if (incSize == 0)
+            return false;
+        return resize(growth.next(allocSize, incSize, maxSize));
+    }
+
+    void shrinkToFit() {
+        if (shrink && incSize) {
+            // Hysteresis: only shrink, if the array would not need to grow again
+            // within the next growth step, so that alternating add() and erase()
+            // at an allocation boundary does not reallocate each time.
+            unsigned int target = growth.next(size, incSize, maxSize);
+            if (target < allocSize && growth.next(target, incSize, maxSize) <= allocSize) {
+                resize(target);
+            }
+        }
     }
 
   public:
     array(unsigned int startSize = ARRAY_INIT_SIZE, unsigned int maxSize = ARRAY_MAX_SIZE,
-          unsigned int incSize = ARRAY_INC_SIZE, bool shrink = true)
-        : startSize(startSize), maxSize(maxSize), incSize(incSize), shrink(shrink) {
+          unsigned int incSize = ARRAY_INC_SIZE, bool shrink = true,
+          arrayGrowth growth = arrayGrowth(), const Alloc &alloc = Alloc())
+        : startSize(startSize), maxSize(maxSize), incSize(incSize), shrink(shrink),
+          growth(growth), alloc(alloc) {
         /*!
          * Constructs an array object. All allocation-hints are optional, the
          * array class will allocate memory as needed during writes, if
@@ -164,18 +389,25 @@ template <typename T> class array {
          * chunk if the array needs to grow
          * @param shrink Boolean indicating, if the array should deallocate
          * memory, if the array size shrinks (due to erase()).
+         * @param growth Growth policy, see \ref ustd::arrayGrowth, default is
+         * linear growth by incSize.
+         * @param alloc Allocator for the array memory, see
+         * \ref ustd::mallocAllocator.
          */
         size = 0;
         if (maxSize < startSize)
             maxSize = startSize;
         allocSize = startSize;
-        arr = ualloc(allocSize);  // new T[allocSize];
+        arr = ualloc(allocSize);
+        if (arr == nullptr)
+            allocSize = 0;
     }
 
-    array(const T initarray[], unsigned int count) {
+    array(const T initarray[], unsigned int count, const Alloc &alloc = Alloc()) : alloc(alloc) {
         /*! construct array with const T[] c-array of length count
         @param initarray c-array of type T
-        @param count number of entries in initarray */
+        @param count number of entries in initarray
+        @param alloc Allocator for the array memory */
         allocSize = count;
         startSize = count;
         maxSize = ARRAY_MAX_SIZE;
@@ -183,34 +415,74 @@ template <typename T> class array {
         shrink = true;
         size = count;
         bad = {};
-        arr = ualloc(allocSize);  // new T[allocSize];
-        for (unsigned int i = 0; i < size; i++) {
-            arr[i] = initarray[i];
-        }
+        arr = ualloc(allocSize);
+        if (arr)
+            details::copyRange(arr, initarray, size);
+        else
+            size = allocSize = 0;
     }
 
-    array(const array<T> &ar) {
+    array(const array<T, Alloc> &ar)
+        : startSize(ar.startSize), maxSize(ar.maxSize), incSize(ar.incSize), shrink(ar.shrink),
+          growth(ar.growth), allocSize(ar.allocSize), size(ar.size), bad(ar.bad), alloc(ar.alloc) {
         /*! array copy constructor */
-        arr = ualloc(ar.allocSize);
-        if (arr) {
-            // memcpy(arr, ar.arr, ar.size * sizeof(T));
+        arr = ualloc(allocSize);
+        if (arr)
+            details::copyRange(arr, ar.arr, size);
+        else
+            size = allocSize = 0;
+    }
+
+    array(array<T, Alloc> &&ar)
+        : arr(ar.arr), startSize(ar.startSize), maxSize(ar.maxSize), incSize(ar.incSize),
+          shrink(ar.shrink), growth(ar.growth), allocSize(ar.allocSize), size(ar.size),
+          bad(static_cast<T &&>(ar.bad)), alloc(ar.alloc) {
+        /*! array move constructor, takes over the memory of ar without copying
+        any elements. ar is left empty without allocation, it can be reused. */
+        ar.arr = nullptr;
+        ar.allocSize = 0;
+        ar.size = 0;
+    }
+
+    array<T, Alloc> &operator=(const array<T, Alloc> &ar) {
+        /*! array copy assignment */
+        if (this != &ar) {
+            array<T, Alloc> tmp(ar);
+            *this = static_cast<array<T, Alloc> &&>(tmp);
+        }
+        return *this;
+    }
+
+    array<T, Alloc> &operator=(array<T, Alloc> &&ar) {
+        /*! array move assignment, frees the current content and takes over the
+        memory of ar. */
+        if (this != &ar) {
+            if (arr != nullptr) {
+                details::destroyRange(arr, size);
+                ufree(arr, allocSize);
+            }
+            arr = ar.arr;
             startSize = ar.startSize;
             maxSize = ar.maxSize;
             incSize = ar.incSize;
             shrink = ar.shrink;
+            growth = ar.growth;
             allocSize = ar.allocSize;
             size = ar.size;
-            bad = ar.bad;
-            for (unsigned int i = 0; i < size; i++) {
-                arr[i] = ar.arr[i];
-            }
+            bad = static_cast<T &&>(ar.bad);
+            alloc = ar.alloc;
+            ar.arr = nullptr;
+            ar.allocSize = 0;
+            ar.size = 0;
         }
+        return *this;
     }
 
     ~array() {
         /*! Free resources */
         if (arr != nullptr) {
-            ufree(arr);
+            details::destroyRange(arr, size);
+            ufree(arr, allocSize);
             arr = nullptr;
         }
     }
@@ -244,7 +516,6 @@ template <typename T> class array {
          * @param newSize the new number of array entries, corresponding memory
          * is allocated/freed as necessary.
          */
-        unsigned int mv = newSize;
         if (newSize > maxSize) {
             if (maxSize == allocSize)
                 return false;
@@ -254,23 +525,19 @@ template <typename T> class array {
         if (!shrink) {
             if (newSize <= allocSize)
                 return true;
-        } else {
-            if (newSize < allocSize)
-                mv = newSize;
-            else
-                mv = allocSize;
         }
-        T *arrn = ualloc(newSize ? newSize : ARRAY_INIT_SIZE);  // new T[newSize];
+        if (newSize == 0)
+            newSize = ARRAY_INIT_SIZE < maxSize ? ARRAY_INIT_SIZE : maxSize;
+        if (newSize < size) {
+            details::destroyRange(arr + newSize, size - newSize);
+            size = newSize;
+        }
+        // reallocate() for trivially copyable T, otherwise move into a new block
+        T *arrn = details::reallocRange(alloc, arr, size, allocSize, newSize);
         if (arrn == nullptr)
             return false;
-        for (unsigned int i = 0; i < mv; i++) {
-            arrn[i] = arr[i];
-        }
-        ufree(arr);
         arr = arrn;
-        allocSize = newSize ? newSize : ARRAY_INIT_SIZE;
-        if (newSize < size)
-            size = newSize;
+        allocSize = newSize;
         return true;
     }
 
@@ -285,19 +552,40 @@ template <typename T> class array {
         bad = entryInvalidValue;
     }
 
-    int add(T &entry) {
+    int add(const T &entry) {
         /*! Append an array element after the current end of the array
          * @param entry array element that is appended after the last current
          * entry. The new array size must be smaller than maxSize as defined
          * during array creation. New array memory is automatically allocated if
-         * within maxSize boundaries. */
-        if (size >= allocSize) {
-            if (incSize == 0)
-                return -1;
-            if (!resize(allocSize + incSize))
-                return -1;
-        }
-        arr[size] = entry;
+         * within maxSize boundaries.
+         * @return index of the new entry or -1 on error */
+        if (!reserveOne())
+            return -1;
+        ::new (static_cast<void *>(arr + size)) T(entry);
+        ++size;
+        return size - 1;
+    }
+
+    int add(T &&entry) {
+        /*! Append an array element by moving it after the current end of the
+         * array, see add(const T &entry).
+         * @param entry array element that is moved into the array
+         * @return index of the new entry or -1 on error */
+        if (!reserveOne())
+            return -1;
+        ::new (static_cast<void *>(arr + size)) T(static_cast<T &&>(entry));
+        ++size;
+        return size - 1;
+    }
+
+    template <typename... Args> int emplace(Args &&...args) {
+        /*! Construct a new array element from args after the current end of the
+         * array, see add(const T &entry).
+         * @param args constructor arguments for the new element
+         * @return index of the new entry or -1 on error */
+        if (!reserveOne())
+            return -1;
+        ::new (static_cast<void *>(arr + size)) T(static_cast<Args &&>(args)...);
         ++size;
         return size - 1;
     }
@@ -311,23 +599,132 @@ template <typename T> class array {
         if (index >= size) {
             return false;
         }
-        for (unsigned int i = index; i < size - 1; i++) {
-            arr[i] = arr[i + 1];
+        details::moveLeft(arr + index, arr + index + 1, size - index - 1);
+        --size;
+        details::destroyRange(arr + size, 1);
+        shrinkToFit();
+        return true;
+    }
+
+    bool eraseUnordered(unsigned int index) {
+        /*! Delete array element at given index in O(1) by moving the last
+         * element into its place. The order of the array is not preserved.
+         * @param index The array index of the element to be erased. The array
+         * size is reduced by 1, and memory might be freed, if shrink=True
+         * during array creation.
+         */
+        if (index >= size) {
+            return false;
         }
         --size;
-        if (shrink) {
-            if ((size < allocSize - incSize) && (allocSize > incSize)) {
-                resize(allocSize - incSize);
-            }
+        if (index != size)
+            arr[index] = static_cast<T &&>(arr[size]);
+        details::destroyRange(arr + size, 1);
+        shrinkToFit();
+        return true;
+    }
+
+    bool reserve(unsigned int count) {
+        /*! Make sure that memory for at least count entries is allocated, so
+         * that the next adds don't need to reallocate.
+         * @param count number of entries to allocate, must be <= maxSize
+         * @return true on success, false if count > maxSize or out of memory.
+         */
+        if (count <= allocSize)
+            return true;
+        if (count > maxSize)
+            return false;
+        return resize(count);
+    }
+
+    bool insert(unsigned int index, const T *entries, unsigned int count) {
+        /*! Insert count entries before index. The tail of the array is moved
+         * only once and memory is reallocated at most once.
+         * @param index position of the first inserted entry, index ==
+         * length() appends.
+         * @param entries pointer to count entries of type T
+         * @param count number of entries to insert
+         * @return true on success, false if index is out of range or the array
+         * can't grow enough. */
+        if (index > size || count > maxSize - size)
+            return false;
+        if (count == 0)
+            return true;
+        if (entries + count > arr && entries < arr + size) {
+            // entries from this array would be moved by the insert: copy first
+            array<T, Alloc> tmp(entries, count, alloc);
+            if (tmp.length() != count)
+                return false;  // out of memory for the copy
+            return insert(index, tmp.arr, count);
         }
+        if (size + count > allocSize) {
+            if (incSize == 0)
+                return false;
+            unsigned int target = growth.next(allocSize, incSize, maxSize);
+            if (target < size + count)
+                target = size + count;
+            T *arrn = details::reallocGap(alloc, arr, size, allocSize, target, index, count);
+            if (arrn == nullptr)
+                return false;
+            arr = arrn;
+            allocSize = target;
+        } else {
+            details::relocateUp(arr + index, size - index, count);
+        }
+        details::copyRange(arr + index, entries, count);
+        size += count;
+        return true;
+    }
+
+    bool addRange(const T *entries, unsigned int count) {
+        /*! Append count entries after the current end of the array with at
+         * most one reallocation.
+         * @param entries pointer to count entries of type T
+         * @param count number of entries to append
+         * @return true on success, false if the array can't grow enough. */
+        return insert(size, entries, count);
+    }
+
+    bool addRange(const array<T, Alloc> &ar) {
+        /*! Append all entries of array ar, see addRange(const T *, unsigned int).
+         * @param ar array whose entries are appended
+         * @return true on success */
+        return insert(size, ar.arr, ar.size);
+    }
+
+    bool eraseRange(unsigned int first, unsigned int count) {
+        /*! Delete count entries starting at first. The tail of the array is
+         * moved only once, and memory is reallocated at most once, if
+         * shrink=True during array creation.
+         * @param first index of the first entry to delete
+         * @param count number of entries to delete
+         * @return true on success, false if the range is out of bounds. */
+        if (first > size || count > size - first)
+            return false;
+        if (count == 0)
+            return true;
+        details::moveLeft(arr + first, arr + first + count, size - first - count);
+        size -= count;
+        details::destroyRange(arr + size, count);
+        shrinkToFit();
         return true;
     }
 
+    void clear() {
+        /*! Delete all array elements, but keep the allocated memory. */
+        details::destroyRange(arr, size);
+        size = 0;
+    }
+
     bool erase() {
         /*! Delete all array elements. memory might be freed, if shrink=True
          * during array creation.
          */
-        return resize(0);
+        details::destroyRange(arr, size);
+        size = 0;
+        if (shrink)
+            return resize(0);
+        return true;
     }
 
     T operator[](unsigned int i) const {
@@ -352,20 +749,34 @@ template <typename T> class array {
                 assert(i < allocSize);
             }
 #endif
-            if (!resize(allocSize + incSize)) {
+            if (!resize(growth.next(allocSize, incSize, maxSize))) {
 #if defined(__UNIXOID__)
                 assert(i < allocSize);
 #endif
             }
         }
-        if (i >= size && i <= allocSize)
-            size = i + 1;
         if (i >= allocSize) {
             return bad;
         }
+        if (i >= size) {
+            details::constructRange(arr + size, i + 1 - size);
+            size = i + 1;
+        }
         return arr[i];
     }
 
+    T *data() {
+        /*! Direct access to the contiguous entries, e.g. for algorithms.
+        @return pointer to the first entry, valid until the array is modified */
+        return arr;
+    }
+
+    const T *data() const {
+        /*! Direct read access to the contiguous entries.
+        @return pointer to the first entry, valid until the array is modified */
+        return arr;
+    }
+
     bool isEmpty() const {
         /*! Check, if array is empty.
         @return true if array empty, false otherwise. s*/
@@ -388,3 +799,19 @@ template <typename T> class array {
     }
 };
 }  // namespace ustd
+
+#if defined(USTD_FEATURE_STL)
+#include <iterator>
+namespace std {
+template <typename T> struct iterator_traits<ustd::arrayIterator<T>> {
+    typedef random_access_iterator_tag iterator_category;
+#if __cplusplus >= 202002L
+    typedef contiguous_iterator_tag iterator_concept;
+#endif
+    typedef typename ustd::arrayIterator<T>::value_type value_type;
+    typedef typename ustd::arrayIterator<T>::difference_type difference_type;
+    typedef typename ustd::arrayIterator<T>::pointer pointer;
+    typedef typename ustd::arrayIterator<T>::reference reference;
+};
+}  // namespace std
+#endif
@@ -0,0 +1,115 @@
+// ustd_atomic.h - index types for lock-free producer/consumer structures
+
+#pragma once
+
+#include "ustd_platform.h"
+
+#if defined(USTD_FEATURE_ATOMIC)
+#include <atomic>
+#endif
+
+// Size of a cache line: indices that are written by different cores are placed
+// on separate lines to avoid false sharing. Can be overridden before including
+// ustd headers.
+#if !defined(USTD_CACHE_LINE)
+#if defined(__UNIXOID__)
+#define USTD_CACHE_LINE 64
+#elif defined(USTD_FEATURE_ATOMIC)
+#define USTD_CACHE_LINE 32  // ESP32, RP2040
+#else
+#define USTD_CACHE_LINE 0  // single core, no padding
+#endif
+#endif
+
+// Padding of one cache line between members that are written by different
+// cores. Padding instead of alignas() keeps the default alignment of the
+// containing class, so it can be allocated with new before C++17.
+#if USTD_CACHE_LINE > 0
+#define USTD_CACHE_PAD(name) char name[USTD_CACHE_LINE];
+#else
+#define USTD_CACHE_PAD(name)
+#endif
+
+namespace ustd {
+
+namespace details {
+
+#if defined(USTD_FEATURE_ATOMIC)
+
+// Index shared between a writing and a reading thread or core
+class atomicIndex {
+  private:
+    std::atomic<unsigned int> v;
+
+  public:
+    atomicIndex(unsigned int i = 0) : v(i) {
+    }
+
+    unsigned int load() const {
+        // value published by the other side, acquires the data written before
+        return v.load(std::memory_order_acquire);
+    }
+
+    unsigned int loadOwn() const {
+        // value last written by the calling side itself
+        return v.load(std::memory_order_relaxed);
+    }
+
+    void store(unsigned int i) {
+        // publish i, releases all data written before
+        v.store(i, std::memory_order_release);
+    }
+};
+
+#else
+
+// Index shared between the main loop and an interrupt handler on a single
+// core: a volatile word, compiler barriers keep the entry accesses in order.
+class atomicIndex {
+  private:
+    volatile unsigned int v;
+
+    static void barrier() {
+        __asm__ __volatile__("" ::: "memory");
+    }
+
+  public:
+    atomicIndex(unsigned int i = 0) : v(i) {
+    }
+
+    unsigned int load() const {
+#if defined(__AVR__)
+        // 16 bit access takes two instructions on 8 bit AVRs
+        unsigned char sreg = SREG;
+        cli();
+        unsigned int i = v;
+        SREG = sreg;
+#else
+        unsigned int i = v;
+#endif
+        barrier();
+        return i;
+    }
+
+    unsigned int loadOwn() const {
+        return v;  // no concurrent writer
+    }
+
+    void store(unsigned int i) {
+        barrier();
+#if defined(__AVR__)
+        unsigned char sreg = SREG;
+        cli();
+        v = i;
+        SREG = sreg;
+#else
+        v = i;
+#endif
+    }
+};
+
+#endif
+
+}  // namespace details
+
+}  // namespace ustd
@@ -0,0 +1,304 @@
+// ustd_bitarray.h - bit-packed dynamic bitset
+
+#pragma once
+
+#include "ustd_array.h"
+
+namespace ustd {
+
+namespace details {
+
+#if defined(__UNIXOID__)
+typedef unsigned long bitWord;  // 64 bit on LP64 Unixoids
+#else
+typedef unsigned int bitWord;  // native word of the MCU
+#endif
+
+inline unsigned int popcountWord(bitWord w) {
+#if defined(__GNUC__)
+    return __builtin_popcountl(w);
+#else
+    unsigned int n = 0;
+    for (; w; w &= w - 1)
+        ++n;
+    return n;
+#endif
+}
+
+inline unsigned int lowestSetBit(bitWord w) {
+    // index of the lowest set bit, w != 0
+#if defined(__GNUC__)
+    return __builtin_ctzl(w);
+#else
+    unsigned int i = 0;
+    while (!(w & 1)) {
+        w >>= 1;
+        ++i;
+    }
+    return i;
+#endif
+}
+
+}  // namespace details
+
+/*! \brief Bit-packed dynamic bitset.
+
+ustd_bitarray.h stores one bit per flag, packed into machine words, instead of
+one byte (or more) per entry of a ustd::array<bool>. Word-wise operations
+(and, or, xor, count, findFirst) process 16, 32 or 64 flags at once and use
+the compiler's popcount and count-trailing-zeros builtins, which map to
+hardware instructions where available.
+
+Like \ref ustd::array, the bitarray either grows as bits are set beyond the
+current length, or works in static mode without further allocations
+(startSize == maxSize, incSize = 0). All sizes are given in bits.
+
+Make sure to provide the <a
+href="https://github.com/muwerk/ustd/blob/master/README.md">required platform
+define</a> before including ustd headers.
+
+## An example:
+
+~~~{.cpp}
+#define __UNO__ 1   // Platform defines required, see doc, mainpage.
+#include <ustd_bitarray.h>
+
+ustd::bitarray active(32, 32, 0, false);  // 32 channel flags in 4 bytes, static
+
+active.set(3);
+active.set(17);
+if (active.test(3)) {
+    active.reset(3);
+}
+printf("%u active, first %d\n", active.count(), active.findFirst());
+for (int ch = active.findFirst(); ch != -1; ch = active.findNext(ch + 1)) {
+    printf("channel %d\n", ch);
+}
+~~~
+ */
+class bitarray {
+  private:
+    typedef details::bitWord word;
+    static const unsigned int wordBits = sizeof(word) * 8;
+
+    array<word> words;
+    unsigned int nbits;
+    unsigned int maxBits;
+
+    static unsigned int wordsFor(unsigned int bits) {
+        return bits / wordBits + (bits % wordBits ? 1 : 0);
+    }
+
+    void clearTail() {
+        // keep the unused bits of the last word zero, so that count() and
+        // findFirst() don't need to mask
+        if (nbits % wordBits)
+            words.data()[nbits / wordBits] &= ((word)1 << (nbits % wordBits)) - 1;
+    }
+
+  public:
+    bitarray(unsigned int startSize = ARRAY_INIT_SIZE * 8, unsigned int maxSize = ARRAY_MAX_SIZE,
+             unsigned int incSize = ARRAY_INC_SIZE * 8, bool shrink = true,
+             arrayGrowth growth = arrayGrowth())
+        : words(wordsFor(startSize), wordsFor(maxSize), wordsFor(incSize), shrink, growth),
+          nbits(0), maxBits(maxSize) {
+        /*!
+         * Constructs an empty bitarray, sizes are in bits and are rounded up
+         * to full words, see \ref ustd::array::array().
+         * @param startSize The number of bits that are allocated during object
+         * creation
+         * @param maxSize The maximal number of bits.
+         * @param incSize The number of bits that are allocated as a chunk if
+         * the bitarray needs to grow, 0: static bitarray
+         * @param shrink Boolean indicating, if memory should be freed, if the
+         * bitarray shrinks.
+         * @param growth Growth policy, see \ref ustd::arrayGrowth.
+         */
+    }
+
+    bool resize(unsigned int bits) {
+        /*! Change the length of the bitarray, new bits are 0.
+        @param bits new length in bits
+        @return true on success, false if bits exceeds the maximum size or
+        memory is exhausted */
+        if (bits > maxBits)
+            return false;
+        unsigned int n = wordsFor(bits);
+        if (n > words.length()) {
+            unsigned int old = words.length();
+            if (!words.reserve(n))  // a single reallocation for all new words
+                return false;
+            while (words.length() < n) {
+                if (words.add(0) == -1) {
+                    words.eraseRange(old, words.length() - old);
+                    return false;
+                }
+            }
+        } else if (n < words.length()) {
+            words.eraseRange(n, words.length() - n);
+        }
+        nbits = bits;
+        clearTail();
+        return true;
+    }
+
+    bool set(unsigned int index, bool value = true) {
+        /*! Set bit index to value. Setting a bit beyond length() extends the
+        bitarray, if the maximum size allows it.
+        @param index bit number
+        @param value new value of the bit
+        @return true on success, false if index is beyond the maximum size */
+        if (index >= nbits) {
+            if (!value)
+                return true;
+            if (!resize(index + 1))
+                return false;
+        }
+        word m = (word)1 << (index % wordBits);
+        if (value)
+            words.data()[index / wordBits] |= m;
+        else
+            words.data()[index / wordBits] &= ~m;
+        return true;
+    }
+
+    bool reset(unsigned int index) {
+        /*! Set bit index to 0
+        @return true */
+        return set(index, false);
+    }
+
+    bool flip(unsigned int index) {
+        /*! Invert bit index
+        @return true on success, false if index is beyond the maximum size */
+        return set(index, !test(index));
+    }
+
+    bool test(unsigned int index) const {
+        /*! Read bit index
+        @return value of the bit, false for index >= length() */
+        if (index >= nbits)
+            return false;
+        return (words.data()[index / wordBits] >> (index % wordBits)) & 1;
+    }
+
+    bool operator[](unsigned int index) const {
+        /*! Read bit index, same as test() */
+        return test(index);
+    }
+
+    void clear() {
+        /*! Set all bits to 0, the length is kept */
+        for (unsigned int i = 0; i < words.length(); i++)
+            words.data()[i] = 0;
+    }
+
+    void setAll() {
+        /*! Set all bits up to length() to 1 */
+        for (unsigned int i = 0; i < words.length(); i++)
+            words.data()[i] = ~(word)0;
+        clearTail();
+    }
+
+    bool erase() {
+        /*! Delete all bits, the length becomes 0 and memory is freed, if
+        shrink=true during creation. */
+        nbits = 0;
+        return words.erase();
+    }
+
+    bitarray &operator&=(const bitarray &other) {
+        /*! Word-wise and. Bits beyond the length of other become 0. */
+        unsigned int n = words.length();
+        for (unsigned int i = 0; i < n; i++)
+            words.data()[i] &= i < other.words.length() ? other.words.data()[i] : 0;
+        return *this;
+    }
+
+    bitarray &operator|=(const bitarray &other) {
+        /*! Word-wise or. The bitarray is extended to the length of other, if
+        necessary and possible. */
+        if (other.nbits > nbits)
+            resize(other.nbits);
+        unsigned int n = words.length() < other.words.length() ? words.length()
+                                                                  : other.words.length();
+        for (unsigned int i = 0; i < n; i++)
+            words.data()[i] |= other.words.data()[i];
+        clearTail();
+        return *this;
+    }
+
+    bitarray &operator^=(const bitarray &other) {
+        /*! Word-wise xor. The bitarray is extended to the length of other, if
+        necessary and possible. */
+        if (other.nbits > nbits)
+            resize(other.nbits);
+        unsigned int n = words.length() < other.words.length() ? words.length()
+                                                                  : other.words.length();
+        for (unsigned int i = 0; i < n; i++)
+            words.data()[i] ^= other.words.data()[i];
+        clearTail();
+        return *this;
+    }
+
+    unsigned int count() const {
+        /*! Number of bits set to 1 (popcount)
+        @return number of set bits */
+        unsigned int n = 0;
+        for (unsigned int i = 0; i < words.length(); i++)
+            n += details::popcountWord(words.data()[i]);
+        return n;
+    }
+
+    int findNext(unsigned int from) const {
+        /*! Find the first set bit at or after from
+        @param from first bit to check
+        @return index of the bit, or -1 if there is none */
+        if (from >= nbits)
+            return -1;
+        unsigned int i = from / wordBits;
+        word w = words.data()[i] & (~(word)0 << (from % wordBits));
+        while (true) {
+            if (w)
+                return (int)(i * wordBits + details::lowestSetBit(w));
+            if (++i >= words.length())
+                return -1;
+            w = words.data()[i];
+        }
+    }
+
+    int findFirst() const {
+        /*! Find the first set bit (find-first-set)
+        @return index of the lowest set bit, or -1 if no bit is set */
+        return findNext(0);
+    }
+
+    bool any() const {
+        /*! Check, if at least one bit is set */
+        return findFirst() != -1;
+    }
+
+    bool none() const {
+        /*! Check, if no bit is set */
+        return findFirst() == -1;
+    }
+
+    bool all() const {
+        /*! Check, if all bits up to length() are set */
+        return count() == nbits;
+    }
+
+    unsigned int length() const {
+        /*! Number of bits
+        @return length in bits */
+        return nbits;
+    }
+
+    unsigned int alloclen() const {
+        /*! Number of bits that fit into the current allocation
+        @return allocated bits */
+        return words.alloclen() * wordBits;
+    }
+};
+
+}  // namespace ustd
@@ -0,0 +1,394 @@
+// ustd_chunked_array.h - segmented array with stable element addresses
+
+#pragma once
+
+#include "ustd_array.h"
+
+namespace ustd {
+
+// Helper class for chunked_array iterators:
+template <typename T, unsigned int N> class chunkedIterator {
+  private:
+    T *const *chunks;
+    unsigned int position;
+
+  public:
+    typedef T value_type;
+    typedef T &reference;
+    typedef T *pointer;
+
+    chunkedIterator(T *const *chunks, unsigned int position)
+        : chunks(chunks), position(position) {
+    }
+
+    bool operator!=(const chunkedIterator<T, N> &other) const {
+        return position != other.position;
+    }
+
+    bool operator==(const chunkedIterator<T, N> &other) const {
+        return position == other.position;
+    }
+
+    chunkedIterator &operator++() {
+        ++position;
+        return *this;
+    }
+
+    chunkedIterator &operator--() {
+        --position;
+        return *this;
+    }
+
+    T &operator*() const {
+        return chunks[position / N][position % N];
+    }
+
+    T *operator->() const {
+        return &chunks[position / N][position % N];
+    }
+
+    unsigned int index() const {
+        return position;
+    }
+};
+
+/*! \brief Segmented array of fixed-size chunks with stable element addresses.
+
+ustd_chunked_array.h stores the entries in chunks of N entries each and keeps
+a small directory of chunk pointers. Unlike \ref ustd::array, growing never
+relocates entries: add() allocates one more chunk when the last one is full,
+so the array never needs twice its memory during a resize and pointers or
+references to entries stay valid while entries are added. This allows large
+logs or histories to grow in small allocations on MCUs with fragmented heap
+(e.g. ESP8266) without a copy storm. Only the directory (one pointer per
+chunk) is reallocated.
+
+operator[] is O(1): a division by the compile-time constant N (a shift for a
+power of two) and one directory lookup. If the array shrinks, whole chunks are
+released again, one spare chunk is kept to avoid allocating again at a chunk
+boundary.
+
+erase(index) keeps the order of the entries, so entries after index move.
+Addresses are only stable while entries are added or erased at the end.
+
+Make sure to provide the <a
+href="https://github.com/muwerk/ustd/blob/master/README.md">required platform
+define</a> before including ustd headers.
+
+## An example:
+
+~~~{.cpp}
+#define __ESP__ 1   // Platform defines required, see doc, mainpage.
+#include <ustd_chunked_array.h>
+
+struct logEntry {
+    unsigned long time;
+    int value;
+};
+ustd::chunked_array<logEntry, 32> history;  // grows by 32 entries (256 bytes) at a time
+
+history.add({millis(), 42});
+logEntry *first = &history[0];  // stays valid while entries are added
+for (auto &e : history) {
+    printf("%lu: %d\n", e.time, e.value);
+}
+~~~
+ */
+template <typename T, unsigned int N = 16, typename Alloc = mallocAllocator> class chunked_array {
+    static_assert(N > 0, "chunked_array needs at least one entry per chunk");
+
+  private:
+    array<T *, Alloc> dir;
+    unsigned int size;
+    unsigned int maxSize;
+    bool shrink;
+    T bad = {};
+    Alloc alloc;
+
+    static unsigned int chunksFor(unsigned int n) {
+        return n / N + (n % N ? 1 : 0);
+    }
+
+    T *slot(unsigned int i) const {
+        return dir.data()[i / N] + i % N;
+    }
+
+    bool addChunk() {
+        T *chunk = (T *)alloc.allocate(N * sizeof(T));
+        if (chunk == nullptr)
+            return false;
+        if (dir.add(chunk) == -1) {
+            alloc.deallocate(chunk, N * sizeof(T));
+            return false;
+        }
+        return true;
+    }
+
+    void releaseChunks(unsigned int keep) {
+        while (dir.length() > keep) {
+            unsigned int last = dir.length() - 1;
+            alloc.deallocate(dir.data()[last], N * sizeof(T));
+            dir.erase(last);
+        }
+    }
+
+    void shrinkToFit() {
+        // keep one spare chunk, so that alternating add() and erase() at a
+        // chunk boundary does not allocate each time
+        if (shrink)
+            releaseChunks(chunksFor(size) + 1);
+    }
+
+    bool reserveOne() {
+        if (size >= maxSize)
+            return false;
+        if (size < dir.length() * N)
+            return true;
+        return addChunk();
+    }
+
+    void destroyAll() {
+        for (unsigned int i = 0; i < size; i++)
+            slot(i)->~T();
+        size = 0;
+    }
+
+  public:
+    chunked_array(unsigned int maxSize = ARRAY_MAX_SIZE, bool shrink = true,
+                  const Alloc &alloc = Alloc())
+        : dir(4, chunksFor(maxSize), 4, shrink, arrayGrowth::geometric(), alloc), size(0),
+          maxSize(maxSize), shrink(shrink), alloc(alloc) {
+        /*!
+         * Constructs an empty chunked_array, no chunk is allocated until the
+         * first add().
+         * @param maxSize The maximal number of entries.
+         * @param shrink Boolean indicating, if chunks should be freed, if the
+         * array shrinks (due to erase()).
+         * @param alloc Allocator for the chunks and the directory, see
+         * \ref ustd::mallocAllocator.
+         */
+    }
+
+    chunked_array(const chunked_array &other)
+        : dir(4, chunksFor(other.maxSize), 4, other.shrink, arrayGrowth::geometric(), other.alloc),
+          size(0), maxSize(other.maxSize), shrink(other.shrink), bad(other.bad),
+          alloc(other.alloc) {
+        /*! chunked_array copy constructor, the copy is shorter than other if
+        memory is exhausted */
+        for (unsigned int i = 0; i < other.size; i++) {
+            if (add(*other.slot(i)) == -1)
+                break;
+        }
+    }
+
+    chunked_array(chunked_array &&other)
+        : dir(static_cast<array<T *, Alloc> &&>(other.dir)), size(other.size),
+          maxSize(other.maxSize), shrink(other.shrink), bad(static_cast<T &&>(other.bad)),
+          alloc(other.alloc) {
+        /*! chunked_array move constructor, takes over the chunks of other.
+        other is left empty, it can be reused. */
+        other.size = 0;
+    }
+
+    chunked_array &operator=(const chunked_array &other) {
+        /*! chunked_array copy assignment */
+        if (this != &other) {
+            chunked_array tmp(other);
+            *this = static_cast<chunked_array &&>(tmp);
+        }
+        return *this;
+    }
+
+    chunked_array &operator=(chunked_array &&other) {
+        /*! chunked_array move assignment, frees the current content and takes
+        over the chunks of other. */
+        if (this != &other) {
+            destroyAll();
+            releaseChunks(0);
+            dir = static_cast<array<T *, Alloc> &&>(other.dir);
+            size = other.size;
+            maxSize = other.maxSize;
+            shrink = other.shrink;
+            bad = static_cast<T &&>(other.bad);
+            alloc = other.alloc;
+            other.size = 0;
+        }
+        return *this;
+    }
+
+    ~chunked_array() {
+        /*! Free resources */
+        destroyAll();
+        releaseChunks(0);
+    }
+
+    static constexpr unsigned int chunkSize() {
+        /*! Number of entries per chunk
+        @return N */
+        return N;
+    }
+
+    chunkedIterator<T, N> begin() {
+        /*! Iterator support: begin() */
+        return chunkedIterator<T, N>(dir.data(), 0);
+    }
+
+    chunkedIterator<T, N> end() {
+        /*! Iterator support: end() */
+        return chunkedIterator<T, N>(dir.data(), size);
+    }
+
+    chunkedIterator<const T, N> begin() const {
+        /*! Iterator support: begin() */
+        return chunkedIterator<const T, N>(dir.data(), 0);
+    }
+
+    chunkedIterator<const T, N> end() const {
+        /*! Iterator support: end() */
+        return chunkedIterator<const T, N>(dir.data(), size);
+    }
+
+    void setInvalidValue(T &entryInvalidValue) {
+        /*! Set the value that's given back, if read of an invalid index is
+        requested, see \ref ustd::array::setInvalidValue() */
+        bad = entryInvalidValue;
+    }
+
+    int add(const T &entry) {
+        /*! Append an entry, existing entries are never moved
+        @param entry entry to be appended
+        @return index of the new entry or -1 on error */
+        if (!reserveOne())
+            return -1;
+        ::new (static_cast<void *>(slot(size))) T(entry);
+        return (int)size++;
+    }
+
+    int add(T &&entry) {
+        /*! Append an entry by moving it into the array
+        @return index of the new entry or -1 on error */
+        if (!reserveOne())
+            return -1;
+        ::new (static_cast<void *>(slot(size))) T(static_cast<T &&>(entry));
+        return (int)size++;
+    }
+
+    template <typename... Args> int emplace(Args &&...args) {
+        /*! Construct a new entry in place at the end of the array
+        @return index of the new entry or -1 on error */
+        if (!reserveOne())
+            return -1;
+        ::new (static_cast<void *>(slot(size))) T(static_cast<Args &&>(args)...);
+        return (int)size++;
+    }
+
+    bool erase(unsigned int index) {
+        /*! Delete entry at index, the order is kept: entries after index move
+        one position down. Chunks that are no longer needed are freed, if
+        shrink=true during creation.
+        @return true on success, false if index is out of range */
+        if (index >= size)
+            return false;
+        for (unsigned int i = index; i + 1 < size; i++)
+            *slot(i) = static_cast<T &&>(*slot(i + 1));
+        --size;
+        slot(size)->~T();
+        shrinkToFit();
+        return true;
+    }
+
+    bool eraseUnordered(unsigned int index) {
+        /*! Delete entry at index in O(1) by moving the last entry into its
+        place
+        @return true on success, false if index is out of range */
+        if (index >= size)
+            return false;
+        if (index != size - 1)
+            *slot(index) = static_cast<T &&>(*slot(size - 1));
+        --size;
+        slot(size)->~T();
+        shrinkToFit();
+        return true;
+    }
+
+    bool reserve(unsigned int count) {
+        /*! Allocate the chunks for count entries in advance
+        @return true on success, false if count exceeds the maximum size or
+        memory is exhausted */
+        if (count > maxSize)
+            return false;
+        while (dir.length() < chunksFor(count)) {
+            if (!addChunk())
+                return false;
+        }
+        return true;
+    }
+
+    void clear() {
+        /*! Delete all entries, but keep the allocated chunks. */
+        destroyAll();
+    }
+
+    bool erase() {
+        /*! Delete all entries. All chunks are freed, if shrink=true during
+        creation. */
+        destroyAll();
+        if (shrink)
+            releaseChunks(0);
+        return true;
+    }
+
+    T operator[](unsigned int i) const {
+        /*! Read content of entry i, a=myChunkedArray[3] */
+        if (i >= size) {
+#if defined(__UNIXOID__)
+            assert(i < size);
+#endif
+            return bad;
+        }
+        return *slot(i);
+    }
+
+    T &operator[](unsigned int i) {
+        /*! Assign content of entry i, e.g. myChunkedArray[3]=3. Like
+        \ref ustd::array, the array is extended with default-constructed entries
+        up to i, if necessary. */
+        while (i >= size) {
+            if (!reserveOne()) {
+#if defined(__UNIXOID__)
+                assert(i < size);
+#endif
+                return bad;
+            }
+            ::new (static_cast<void *>(slot(size))) T();
+            ++size;
+        }
+        return *slot(i);
+    }
+
+    bool isEmpty() const {
+        /*! Check, if the array is empty.
+        @return true if empty */
+        return size == 0;
+    }
+
+    unsigned int length() const {
+        /*! Number of entries
+        @return number of entries */
+        return size;
+    }
+
+    unsigned int chunks() const {
+        /*! Number of allocated chunks
+        @return number of chunks */
+        return dir.length();
+    }
+
+    unsigned int alloclen() const {
+        /*! Number of entries that fit into the allocated chunks
+        @return allocated entries */
+        return dir.length() * N;
+    }
+};
+
+}  // namespace ustd
@@ -0,0 +1,191 @@
+// ustd_flash_table.h - read-only tables in flash memory
+
+#pragma once
+
+#include "ustd_memory.h"
+
+#if defined(USTD_FEATURE_PROGMEM)
+#include <avr/pgmspace.h>
+#define USTD_FLASH PROGMEM  // place a const table in flash
+#else
+#define USTD_FLASH  // const data is addressable directly, nothing to do
+#endif
+
+namespace ustd {
+
+namespace details {
+
+template <typename T> inline T flashRead(const T *p) {
+    // read one entry of a USTD_FLASH table
+#if defined(USTD_FEATURE_PROGMEM)
+    T v;
+    memcpy_P((void *)&v, (const void *)p, sizeof(T));
+    return v;
+#else
+    return *p;
+#endif
+}
+
+}  // namespace details
+
+// Helper class for flash_table iterators, entries are read by value:
+template <typename T> class flashIterator {
+  private:
+    const T *p;
+
+  public:
+    typedef T value_type;
+    typedef long difference_type;
+
+    flashIterator(const T *p) : p(p) {
+    }
+
+    bool operator!=(const flashIterator<T> &other) const {
+        return p != other.p;
+    }
+
+    bool operator==(const flashIterator<T> &other) const {
+        return p == other.p;
+    }
+
+    bool operator<(const flashIterator<T> &other) const {
+        return p < other.p;
+    }
+
+    flashIterator &operator++() {
+        ++p;
+        return *this;
+    }
+
+    flashIterator &operator--() {
+        --p;
+        return *this;
+    }
+
+    flashIterator operator+(difference_type n) const {
+        return flashIterator(p + n);
+    }
+
+    flashIterator operator-(difference_type n) const {
+        return flashIterator(p - n);
+    }
+
+    difference_type operator-(const flashIterator<T> &other) const {
+        return p - other.p;
+    }
+
+    T operator*() const {
+        return details::flashRead(p);
+    }
+
+    T operator[](difference_type n) const {
+        return details::flashRead(p + n);
+    }
+};
+
+/*! \brief Read-only view of a constant table that stays in flash memory.
+
+ustd_flash_table.h provides access to constant tables (lookup or calibration
+tables) without copying them to RAM, unlike
+\ref ustd::array::array(const T initarray[], unsigned int count).
+
+Declare the table with USTD_FLASH: on AVR (USTD_FEATURE_PROGMEM) the table is
+placed in flash with PROGMEM and every entry is read with memcpy_P(), on all
+other platforms USTD_FLASH is empty and entries are read directly. The table
+itself costs zero RAM on AVR, the flash_table object is just a pointer and a
+length.
+
+Entries are returned by value, so T must be trivially copyable (int, float,
+POD structs). flash_table supports iteration, and lowerBound(), upperBound()
+and binarySearch() from \ref ustd_algorithm.h.
+
+Make sure to provide the <a
+href="https://github.com/muwerk/ustd/blob/master/README.md">required platform
+define</a> before including ustd headers.
+
+## An example:
+
+~~~{.cpp}
+#define __UNO__ 1   // Platform defines required, see doc, mainpage.
+#include <ustd_flash_table.h>
+#include <ustd_algorithm.h>
+
+// ADC reading -> temperature in 0.1 C, sorted by ADC value
+struct calPoint {
+    int adc;
+    int temp;
+};
+const calPoint calibration[] USTD_FLASH = {{100, -200}, {300, 0}, {600, 250}, {900, 800}};
+
+ustd::flash_table<calPoint> cal(calibration);  // no RAM copy
+
+bool byAdc(const calPoint &p, const int &adc) {
+    return p.adc < adc;
+}
+
+unsigned int i = ustd::lowerBound(cal, 450, byAdc);  // first point with adc >= 450
+calPoint hi = cal[i];
+for (auto p : cal) {
+    printf("%d -> %d\n", p.adc, p.temp);
+}
+~~~
+ */
+template <typename T> class flash_table {
+    static_assert(USTD_IS_TRIVIALLY_COPYABLE(T), "flash_table entries must be trivially copyable");
+
+  private:
+    const T *table;
+    unsigned int size;
+
+  public:
+    flash_table(const T *table, unsigned int count) : table(table), size(count) {
+        /*! View of count entries of a USTD_FLASH table
+        @param table pointer to the table in flash
+        @param count number of entries */
+    }
+
+    template <unsigned int N> flash_table(const T (&table)[N]) : table(table), size(N) {
+        /*! View of a complete USTD_FLASH C array, the length is taken from the
+        array type */
+    }
+
+    flashIterator<T> begin() const {
+        /*! Iterator support: begin() */
+        return flashIterator<T>(table);
+    }
+
+    flashIterator<T> end() const {
+        /*! Iterator support: end() */
+        return flashIterator<T>(table + size);
+    }
+
+    T operator[](unsigned int i) const {
+        /*! Read entry i from flash, a=myTable[3]
+        @return entry i, or a value-initialized T, if i >= length() */
+        if (i >= size) {
+#if defined(__UNIXOID__)
+            assert(i < size);
+#endif
+            return T();
+        }
+        return details::flashRead(table + i);
+    }
+
+    const T *data() const {
+        /*! Address of the table. On AVR this is a flash address that must not
+        be dereferenced directly. */
+        return table;
+    }
+
+    bool isEmpty() const {
+        /*! Check, if the table is empty */
+        return size == 0;
+    }
+
+    unsigned int length() const {
+        /*! Number of table entries */
+        return size;
+    }
+};
+
+}  // namespace ustd
@@ -61,7 +61,9 @@ using nullptr_t = decltype(nullptr);
 #endif
 
 // NEW_H is some new Arduino implementation of new operator
-#if !defined(NEW_H) && !defined(USTD_FEATURE_SUPPORTS_NEW_OPERATOR)
+#if !defined(NEW_H) && !defined(USTD_FEATURE_SUPPORTS_NEW_OPERATOR) &&                           \
+    !defined(USTD_PLACEMENT_NEW_DEFINED)
+#define USTD_PLACEMENT_NEW_DEFINED
 inline void *operator new(size_t size, void *ptr) {
     return ptr;
 }
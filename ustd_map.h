@@ -2,6 +2,7 @@
 
 #pragma once
 #include "ustd_array.h"
+#include "ustd_simd.h"
 
 namespace ustd {
 
@@ -47,6 +48,12 @@ double p = myMap[0];
 ustd::map<int, float> mayMap = ustd::map<int,float>(5, 5, 0, false);
 ~~~
 
+## Geometric growth for large maps
+
+~~~{.cpp}
+ustd::map<int, int> bigMap(16, ARRAY_MAX_SIZE, 16, true, ustd::arrayGrowth::geometric());
+~~~
+
 ## Iteration over keys
 
 ~~~{.cpp}
@@ -59,7 +66,7 @@ ustd::map<int, float> mayMap = ustd::map<int,float>(5, 5, 0, false);
 ~~~
  */
 
-template <class K, class V> class map {
+template <class K, class V, class Alloc = mallocAllocator> class map {
   private:
     unsigned int size;
     unsigned int peakSize;
@@ -68,18 +75,20 @@ template <class K, class V> class map {
     unsigned int maxSize;
     unsigned int incSize;
     bool shrink;
+    arrayGrowth growth;
     V bad = {};
 
   public:
-    ustd::array<K> keys;   /*! Array of keys */
-    ustd::array<V> values; /*! Array of values */
+    ustd::array<K, Alloc> keys;   /*! Array of keys */
+    ustd::array<V, Alloc> values; /*! Array of values */
 
   public:
     map(unsigned int startSize = ARRAY_INIT_SIZE, unsigned int maxSize = ARRAY_MAX_SIZE,
-        unsigned int incSize = ARRAY_INC_SIZE, bool shrink = true)
+        unsigned int incSize = ARRAY_INC_SIZE, bool shrink = true,
+        arrayGrowth growth = arrayGrowth(), const Alloc &alloc = Alloc())
         : startSize(startSize), maxSize(maxSize), incSize(incSize), shrink(shrink),
-          keys(array<K>(startSize, maxSize, incSize, shrink)),
-          values(array<V>(startSize, maxSize, incSize, shrink)) {
+          growth(growth), keys(startSize, maxSize, incSize, shrink, growth, alloc),
+          values(startSize, maxSize, incSize, shrink, growth, alloc) {
         /*!
          * Constructs a map object. All allocation-hints are optional, the
          * array class used by map will allocate memory as needed during writes,
@@ -93,25 +102,20 @@ template <class K, class V> class map {
          * chunk if the map needs to grow
          * @param shrink Boolean indicating, if the map should deallocate
          * memory, if the map size shrinks (due to erase()).
+         * @param growth Growth policy of the key and value arrays, see
+         * \ref ustd::arrayGrowth.
+         * @param alloc Allocator for the key and value arrays, see
+         * \ref ustd::mallocAllocator.
          */
 
         size = 0;
         allocSize = startSize;
     }
 
-    /* Implicit, no need:
-    map(const map &mp) {
-        size = mp.size;
-        peakSize = mp.peakSize;
-        allocSize = mp.allocSize;
-        startSize = mp.startSize;
-        maxSize = mp.maxSize;
-        incSize = mp.incSize;
-        shrink = mp.shrink;
-        bad = mp.bad;
-        keys = mp.keys;
-        values = mp.values;
-    } */
+    map(const map<K, V, Alloc> &mp) = default;
+    map(map<K, V, Alloc> &&mp) = default;
+    map<K, V, Alloc> &operator=(const map<K, V, Alloc> &mp) = default;
+    map<K, V, Alloc> &operator=(map<K, V, Alloc> &&mp) = default;
 
     ~map() {
         /*! Free resources */
@@ -122,11 +126,10 @@ template <class K, class V> class map {
         @param key map-key
         @return Corresponding value. The value set be setInvalidValue() is given
         back for invalid reads (or by default a value set to zero) */
-        for (unsigned int i = 0; i < keys.length(); i++) {
-            if (keys[i] == key)
-                return values[i];
-        }
-        return bad;
+        int i = find(key);
+        if (i == -1)
+            return bad;
+        return values[i];
     }
 
     V &operator[](K key) {
@@ -134,12 +137,10 @@ template <class K, class V> class map {
         @param key map-key
         @return value on success, or setInvalidValue() on error (e.g. map full)
       */
-        for (unsigned int i = 0; i < keys.length(); i++) {
-            if (keys[i] == key) {
-                return values[i];
-            }
-        }
-        int i = keys.add(key);
+        int i = find(key);
+        if (i != -1)
+            return values[i];
+        i = keys.add(key);
         if (i == -1) {
             return bad;
         }
@@ -150,15 +151,14 @@ template <class K, class V> class map {
         return bad;
     }
 
-    int find(K key) {
-        /*! Get the index of the key and value arrays of the map
+    int find(K key) const {
+        /*! Get the index of the key and value arrays of the map. Integral
+        keys (char, short, int, long, long long, signed and unsigned) and float
+        keys are compared with SIMD instructions on Unixoids, see
+        \ref ustd_simd.h.
         @param key Map-key.
         @return index, if found, -1 on error */
-        for (unsigned int i = 0; i < keys.length(); i++) {
-            if (keys[i] == key)
-                return i;
-        }
-        return -1;
+        return indexOf(keys, key);
     }
 
     int erase(K key) {
@@ -166,14 +166,29 @@ template <class K, class V> class map {
         memory-deallocation, if shrink=True during map creation
         @param key Map-key of entry to be deleted
         @return index of entry been deleted or -1 on error */
-        for (unsigned int i = 0; i < keys.length(); i++) {
-            if (keys[i] == key) {
-                values.erase(i);
-                keys.erase(i);
-                return i;
-            }
-        }
-        return -1;
+        int i = find(key);
+        if (i == -1)
+            return -1;
+        values.erase(i);
+        keys.erase(i);
+        --size;
+        return i;
+    }
+
+    int eraseUnordered(K key) {
+        /*! Delete the entry corresponding to map-key in O(1) after the lookup by
+        moving the last entry into its place. The order of keysArray() is not
+        preserved. This might lead to memory-deallocation, if shrink=True during
+        map creation.
+        @param key Map-key of entry to be deleted
+        @return index of entry been deleted or -1 on error */
+        int i = find(key);
+        if (i == -1)
+            return -1;
+        values.eraseUnordered(i);
+        keys.eraseUnordered(i);
+        --size;
+        return i;
     }
 
     void setInvalidValue(V &entryInvalidValue) {
@@ -195,7 +210,7 @@ template <class K, class V> class map {
             return false;
     }
 
-    const ustd::array<K> &keysArray() {
+    const ustd::array<K, Alloc> &keysArray() {
         /*! Reference to array of keys
 
         @return const reference to array of keys, e.g. for iteration.
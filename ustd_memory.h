@@ -0,0 +1,251 @@
+// ustd_memory.h - uninitialized storage helpers for ustd containers
+
+#pragma once
+
+/*! \file ustd_memory.h
+Helpers for containers that manage raw, uninitialized storage.
+
+ustd containers allocate raw memory and only construct the elements that are
+actually in use. The functions in ustd::details construct, move and destroy
+ranges of such elements. They are used internally by \ref ustd::array and
+\ref ustd::queue and are not part of the public API.
+
+The memory itself comes from an allocator, by default \ref ustd::mallocAllocator.
+
+For trivially copyable element types (int, float, POD structs) the helpers are
+selected at compile time to use memcpy(), memmove() and reallocate(), all other
+types are handled element by element with their constructors, assignment
+operators and destructors.
+
+Make sure to provide the <a
+href="https://github.com/muwerk/ustd/blob/master/README.md">required platform
+define</a> before including ustd headers.
+*/
+
+#include "ustd_platform.h"
+
+#if defined(__UNIXOID__) || defined(__ESP__) || defined(USTD_FEATURE_SUPPORTS_NEW_OPERATOR)
+#include <new>
+#elif !defined(NEW_H) && !defined(USTD_PLACEMENT_NEW_DEFINED)
+// Placement new for cores that do not provide <new> (same as ustd_functional.h)
+#define USTD_PLACEMENT_NEW_DEFINED
+inline void *operator new(size_t size, void *ptr) {
+    return ptr;
+}
+#endif
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ < 5
+// older gcc (e.g. ESP8266 core 2.x) have no __is_trivially_copyable
+#define USTD_IS_TRIVIALLY_COPYABLE(T) (__has_trivial_copy(T) && __has_trivial_destructor(T))
+#else
+#define USTD_IS_TRIVIALLY_COPYABLE(T) __is_trivially_copyable(T)
+#endif
+
+namespace ustd {
+namespace details {
+
+template <bool B> struct boolTag {};
+typedef boolTag<true> trivialTag;
+typedef boolTag<false> nonTrivialTag;
+
+template <typename T> struct isTrivial {
+    // true, if T can be copied with memcpy and needs no destructor call
+    static const bool value = USTD_IS_TRIVIALLY_COPYABLE(T);
+    typedef boolTag<value> tag;
+};
+
+template <typename T> struct removeConst {
+    typedef T type;
+};
+template <typename T> struct removeConst<const T> {
+    typedef T type;
+};
+
+template <typename T> inline void constructRange(T *p, unsigned int count) {
+    // value-initialize count elements at p (zero for arithmetic types)
+    for (unsigned int i = 0; i < count; i++) {
+        ::new (static_cast<void *>(p + i)) T();
+    }
+}
+
+template <typename T>
+inline void copyRange(T *dst, const T *src, unsigned int count, nonTrivialTag) {
+    for (unsigned int i = 0; i < count; i++) {
+        ::new (static_cast<void *>(dst + i)) T(src[i]);
+    }
+}
+template <typename T>
+inline void copyRange(T *dst, const T *src, unsigned int count, trivialTag) {
+    if (count)
+        memcpy((void *)dst, (const void *)src, count * sizeof(T));
+}
+template <typename T> inline void copyRange(T *dst, const T *src, unsigned int count) {
+    // copy-construct count elements from src into uninitialized dst
+    copyRange(dst, src, count, typename isTrivial<T>::tag());
+}
+
+template <typename T> inline void relocateRange(T *dst, T *src, unsigned int count, nonTrivialTag) {
+    for (unsigned int i = 0; i < count; i++) {
+        ::new (static_cast<void *>(dst + i)) T(static_cast<T &&>(src[i]));
+        src[i].~T();
+    }
+}
+template <typename T> inline void relocateRange(T *dst, T *src, unsigned int count, trivialTag) {
+    if (count)
+        memcpy((void *)dst, (const void *)src, count * sizeof(T));
+}
+template <typename T> inline void relocateRange(T *dst, T *src, unsigned int count) {
+    // move count elements from src into uninitialized dst, src is destroyed
+    relocateRange(dst, src, count, typename isTrivial<T>::tag());
+}
+
+template <typename T> inline void moveLeft(T *dst, T *src, unsigned int count, nonTrivialTag) {
+    for (unsigned int i = 0; i < count; i++) {
+        dst[i] = static_cast<T &&>(src[i]);
+    }
+}
+template <typename T> inline void moveLeft(T *dst, T *src, unsigned int count, trivialTag) {
+    if (count)
+        memmove((void *)dst, (const void *)src, count * sizeof(T));
+}
+template <typename T> inline void moveLeft(T *dst, T *src, unsigned int count) {
+    // move-assign count live elements from src to dst, dst < src, ranges may overlap
+    moveLeft(dst, src, count, typename isTrivial<T>::tag());
+}
+
+template <typename T> inline void moveOut(T *dst, T *src, unsigned int count, nonTrivialTag) {
+    for (unsigned int i = 0; i < count; i++) {
+        dst[i] = static_cast<T &&>(src[i]);
+        src[i].~T();
+    }
+}
+template <typename T> inline void moveOut(T *dst, T *src, unsigned int count, trivialTag) {
+    if (count)
+        memcpy((void *)dst, (const void *)src, count * sizeof(T));
+}
+template <typename T> inline void moveOut(T *dst, T *src, unsigned int count) {
+    // move-assign count elements from src to live dst, src is destroyed, no overlap
+    moveOut(dst, src, count, typename isTrivial<T>::tag());
+}
+
+template <typename T>
+inline void relocateUp(T *src, unsigned int count, unsigned int by, nonTrivialTag) {
+    for (unsigned int i = count; i > 0; i--) {
+        ::new (static_cast<void *>(src + i - 1 + by)) T(static_cast<T &&>(src[i - 1]));
+        src[i - 1].~T();
+    }
+}
+template <typename T> inline void relocateUp(T *src, unsigned int count, unsigned int by, trivialTag) {
+    if (count)
+        memmove((void *)(src + by), (const void *)src, count * sizeof(T));
+}
+template <typename T> inline void relocateUp(T *src, unsigned int count, unsigned int by) {
+    // move count live elements at src up by entries, ranges may overlap. The
+    // destination beyond the live range must be uninitialized, afterwards
+    // [src, src + by) is uninitialized.
+    relocateUp(src, count, by, typename isTrivial<T>::tag());
+}
+
+template <typename T> inline void destroyRange(T *p, unsigned int count, nonTrivialTag) {
+    for (unsigned int i = 0; i < count; i++) {
+        p[i].~T();
+    }
+}
+template <typename T> inline void destroyRange(T *, unsigned int, trivialTag) {
+}
+template <typename T> inline void destroyRange(T *p, unsigned int count) {
+    // call the destructors of count elements at p
+    destroyRange(p, count, typename isTrivial<T>::tag());
+}
+
+template <typename T, typename Alloc>
+inline T *reallocRange(Alloc &alloc, T *p, unsigned int live, unsigned int oldN, unsigned int n,
+                       nonTrivialTag) {
+    T *pn = (T *)alloc.allocate(n * sizeof(T));
+    if (pn == nullptr)
+        return nullptr;
+    relocateRange(pn, p, live);
+    if (p != nullptr)
+        alloc.deallocate(p, oldN * sizeof(T));
+    return pn;
+}
+template <typename T, typename Alloc>
+inline T *reallocRange(Alloc &alloc, T *p, unsigned int, unsigned int oldN, unsigned int n,
+                       trivialTag) {
+    return (T *)alloc.reallocate(p, oldN * sizeof(T), n * sizeof(T));
+}
+template <typename T, typename Alloc>
+inline T *reallocRange(Alloc &alloc, T *p, unsigned int live, unsigned int oldN, unsigned int n) {
+    // Change the allocation of block p (oldN entries, live elements) from alloc
+    // to n entries (live <= n). On failure nullptr is returned and p is untouched.
+    return reallocRange(alloc, p, live, oldN, n, typename isTrivial<T>::tag());
+}
+
+template <typename T, typename Alloc>
+inline T *reallocGap(Alloc &alloc, T *p, unsigned int live, unsigned int oldN, unsigned int n,
+                     unsigned int index, unsigned int count, nonTrivialTag) {
+    T *pn = (T *)alloc.allocate(n * sizeof(T));
+    if (pn == nullptr)
+        return nullptr;
+    relocateRange(pn, p, index);
+    relocateRange(pn + index + count, p + index, live - index);
+    if (p != nullptr)
+        alloc.deallocate(p, oldN * sizeof(T));
+    return pn;
+}
+template <typename T, typename Alloc>
+inline T *reallocGap(Alloc &alloc, T *p, unsigned int live, unsigned int oldN, unsigned int n,
+                     unsigned int index, unsigned int count, trivialTag) {
+    T *pn = (T *)alloc.reallocate(p, oldN * sizeof(T), n * sizeof(T));
+    if (pn != nullptr)
+        relocateUp(pn + index, live - index, count, trivialTag());
+    return pn;
+}
+template <typename T, typename Alloc>
+inline T *reallocGap(Alloc &alloc, T *p, unsigned int live, unsigned int oldN, unsigned int n,
+                     unsigned int index, unsigned int count) {
+    // Like reallocRange(), but additionally opens an uninitialized gap of count
+    // entries at index (live + count <= n), each element is moved only once.
+    return reallocGap(alloc, p, live, oldN, n, index, count, typename isTrivial<T>::tag());
+}
+
+}  // namespace details
+
+/*! \brief Default allocator of ustd containers, uses malloc(), realloc() and free().
+
+\ref ustd::array, \ref ustd::small_array, \ref ustd::map and \ref ustd::queue
+take an allocator class as optional last template parameter. An allocator is a small class with the
+following three methods, the containers keep a copy of the allocator:
+
+~~~{.cpp}
+class myAllocator {
+  public:
+    void *allocate(size_t bytes);  // nullptr on failure
+    void deallocate(void *p, size_t bytes);  // bytes as given to allocate()
+    // Resize block p (may be nullptr) from oldBytes to newBytes, keeping the
+    // content. On failure, return nullptr and leave p untouched.
+    void *reallocate(void *p, size_t oldBytes, size_t newBytes);
+};
+
+ustd::array<int, myAllocator> ar(16, ARRAY_MAX_SIZE, 16, true, ustd::arrayGrowth(), myAllocator());
+~~~
+*/
+class mallocAllocator {
+  public:
+    void *allocate(size_t bytes) {
+        /*! Allocate bytes of raw memory
+        @return pointer to memory or nullptr */
+        return malloc(bytes);
+    }
+    void deallocate(void *p, size_t) {
+        /*! Free memory p allocated by allocate() or reallocate() */
+        free(p);
+    }
+    void *reallocate(void *p, size_t, size_t newBytes) {
+        /*! Resize memory block p, see realloc()
+        @return pointer to resized block or nullptr (p is untouched) */
+        return realloc(p, newBytes);
+    }
+};
+
+}  // namespace ustd
@@ -0,0 +1,314 @@
+// ustd_mpmc_queue.h - bounded lock-free multi-producer/multi-consumer queue
+
+#pragma once
+
+#include "ustd_memory.h"
+#include "ustd_atomic.h"
+
+#if !defined(USTD_FEATURE_ATOMIC)
+#error "ustd_mpmc_queue.h requires a platform with USTD_FEATURE_ATOMIC"
+#endif
+
+namespace ustd {
+
+namespace details {
+
+template <typename T> struct mpmcCell {
+    std::atomic<size_t> seq;
+    alignas(T) unsigned char storage[sizeof(T)];
+
+    T *entry() {
+        return reinterpret_cast<T *>(storage);
+    }
+};
+
+}  // namespace details
+
+/*! \brief Bounded lock-free multi-producer/multi-consumer queue.
+
+ustd_mpmc_queue.h provides a fixed-size queue that any number of threads can
+push to and pop from concurrently without a mutex, using per-slot sequence
+numbers (D. Vyukov's bounded MPMC queue). Producers and consumers only contend
+on a compare-and-swap of the enqueue or dequeue position, which are separated
+by cache line padding, and never block each other on a lock. The padding keeps
+the default alignment, so queues can also be allocated with new.
+
+The capacity is rounded up to a power of two. tryPush() and tryPop() never
+wait, they fail if the queue is full or empty. The batch variants
+tryPushN() and tryPopN() claim as many consecutive slots as possible with a
+single compare-and-swap.
+
+length() and peak() give the same observability as \ref ustd::queue, the
+values are snapshots while other threads are active. Available on platforms
+with USTD_FEATURE_ATOMIC (Unixoids, ESP32, RP2040), for a single producer and
+a single consumer \ref ustd::spsc_queue is cheaper.
+
+Make sure to provide the <a
+href="https://github.com/muwerk/ustd/blob/master/README.md">required platform
+define</a> before including ustd headers.
+
+## An example:
+
+~~~{.cpp}
+#define __UNIXOID__ 1  // Appropriate platform define required
+#include <ustd_mpmc_queue.h>
+
+ustd::mpmc_queue<int> jobs(1024);
+
+void worker() {  // any number of worker threads
+    int batch[16];
+    unsigned int n;
+    while ((n = jobs.tryPopN(batch, 16)) > 0) {
+        for (unsigned int i = 0; i < n; i++)
+            process(batch[i]);
+    }
+}
+
+void publisher(int job) {  // any number of publisher threads
+    while (!jobs.tryPush(job)) {
+        std::this_thread::yield();  // full, back off
+    }
+}
+~~~
+ */
+template <class T, class Alloc = mallocAllocator> class mpmc_queue {
+  private:
+    typedef details::mpmcCell<T> cell;
+
+    cell *cells;
+    size_t mask;  // capacity - 1
+    T bad = {};
+    Alloc alloc;
+
+    USTD_CACHE_PAD(pad0)
+    std::atomic<size_t> enqueuePos;
+    USTD_CACHE_PAD(pad1)
+    std::atomic<size_t> dequeuePos;
+    USTD_CACHE_PAD(pad2)
+    std::atomic<unsigned int> peakSize;
+    USTD_CACHE_PAD(pad3)
+
+    static long diff(size_t a, size_t b) {
+        return static_cast<long>(a - b);
+    }
+
+    size_t claim(std::atomic<size_t> &position, size_t offset, unsigned int count,
+                 unsigned int &n) {
+        // Claim up to count consecutive slots, whose sequence number is
+        // position + offset (free for producers: offset 0, filled for
+        // consumers: offset 1). n is set to the number of claimed slots.
+        size_t pos = position.load(std::memory_order_relaxed);
+        if (cells == nullptr) {
+            n = 0;
+            return pos;
+        }
+        while (true) {
+            long d = diff(cells[pos & mask].seq.load(std::memory_order_acquire), pos + offset);
+            if (d < 0) {
+                n = 0;  // full (producer) or empty (consumer)
+                return pos;
+            }
+            if (d > 0) {
+                pos = position.load(std::memory_order_relaxed);  // pos is stale
+                continue;
+            }
+            unsigned int k = 1;
+            while (k < count && k <= mask &&
+                   cells[(pos + k) & mask].seq.load(std::memory_order_acquire) ==
+                       pos + k + offset)
+                ++k;
+            if (position.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed)) {
+                n = k;
+                return pos;
+            }
+        }
+    }
+
+    void updatePeak(size_t end) {
+        size_t len = end - dequeuePos.load(std::memory_order_relaxed);
+        if (len > mask + 1)
+            return;  // dequeue position moved meanwhile, no valid snapshot
+        unsigned int cur = peakSize.load(std::memory_order_relaxed);
+        while (len > cur && !peakSize.compare_exchange_weak(cur, (unsigned int)len,
+                                                            std::memory_order_relaxed)) {
+        }
+    }
+
+  public:
+    mpmc_queue(unsigned int maxQueueSize, const Alloc &alloc = Alloc())
+        : alloc(alloc), enqueuePos(0), dequeuePos(0), peakSize(0) {
+        /*! Constructs a mpmc_queue object
+        @param maxQueueSize The minimum number of entries, the queue can hold,
+        it is rounded up to the next power of two.
+        @param alloc Allocator for the queue memory, see
+        \ref ustd::mallocAllocator.
+        */
+        size_t n = 2;
+        while (n < maxQueueSize)
+            n <<= 1;
+        cells = (cell *)this->alloc.allocate(sizeof(cell) * n);
+        if (cells == nullptr) {
+            mask = 0;  // all operations fail
+            return;
+        }
+        mask = n - 1;
+        for (size_t i = 0; i < n; i++)
+            ::new (static_cast<void *>(&cells[i].seq)) std::atomic<size_t>(i);
+    }
+
+    mpmc_queue(const mpmc_queue &) = delete;
+    mpmc_queue &operator=(const mpmc_queue &) = delete;
+
+    ~mpmc_queue() {
+        /*! Deallocate the queue, entries that were not popped are destroyed.
+        No thread may access the queue any more. */
+        if (cells == nullptr)
+            return;
+        size_t end = enqueuePos.load(std::memory_order_acquire);
+        for (size_t pos = dequeuePos.load(std::memory_order_acquire); pos != end; pos++)
+            cells[pos & mask].entry()->~T();
+        alloc.deallocate(cells, sizeof(cell) * (mask + 1));
+    }
+
+    bool tryPush(const T &ent) {
+        /*! Push a new entry into the queue, can be called by any thread.
+        @param ent T element
+        @return true on success, false if queue is full.
+        */
+        unsigned int n;
+        size_t pos = claim(enqueuePos, 0, 1, n);
+        if (n == 0)
+            return false;
+        cell &c = cells[pos & mask];
+        ::new (static_cast<void *>(c.storage)) T(ent);
+        c.seq.store(pos + 1, std::memory_order_release);
+        updatePeak(pos + 1);
+        return true;
+    }
+
+    bool tryPush(T &&ent) {
+        /*! Push a new entry into the queue by moving it, can be called by any
+        thread.
+        @return true on success, false if queue is full.
+        */
+        unsigned int n;
+        size_t pos = claim(enqueuePos, 0, 1, n);
+        if (n == 0)
+            return false;
+        cell &c = cells[pos & mask];
+        ::new (static_cast<void *>(c.storage)) T(static_cast<T &&>(ent));
+        c.seq.store(pos + 1, std::memory_order_release);
+        updatePeak(pos + 1);
+        return true;
+    }
+
+    unsigned int tryPushN(const T *entries, unsigned int count) {
+        /*! Push up to count entries with a single claim of consecutive slots.
+        The pushed entries are consecutive in the queue.
+        @param entries entries to push, entries[0] first
+        @param count number of entries
+        @return number of entries pushed, 0 if the queue is full. The entries
+        from the returned index on were not pushed. */
+        if (count == 0)
+            return 0;
+        unsigned int n;
+        size_t pos = claim(enqueuePos, 0, count, n);
+        for (unsigned int i = 0; i < n; i++) {
+            cell &c = cells[(pos + i) & mask];
+            ::new (static_cast<void *>(c.storage)) T(entries[i]);
+            c.seq.store(pos + i + 1, std::memory_order_release);
+        }
+        if (n)
+            updatePeak(pos + n);
+        return n;
+    }
+
+    bool tryPop(T &ent) {
+        /*! Pop the oldest entry from the queue, can be called by any thread.
+        @param ent receives the entry
+        @return true on success, false if the queue is empty, ent is unchanged
+        */
+        unsigned int n;
+        size_t pos = claim(dequeuePos, 1, 1, n);
+        if (n == 0)
+            return false;
+        cell &c = cells[pos & mask];
+        ent = static_cast<T &&>(*c.entry());
+        c.entry()->~T();
+        c.seq.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    unsigned int tryPopN(T *entries, unsigned int count) {
+        /*! Pop up to count of the oldest entries with a single claim of
+        consecutive slots.
+        @param entries receives the entries, oldest first
+        @param count maximum number of entries
+        @return number of entries popped, 0 if the queue is empty */
+        if (count == 0)
+            return 0;
+        unsigned int n;
+        size_t pos = claim(dequeuePos, 1, count, n);
+        for (unsigned int i = 0; i < n; i++) {
+            cell &c = cells[(pos + i) & mask];
+            entries[i] = static_cast<T &&>(*c.entry());
+            c.entry()->~T();
+            c.seq.store(pos + i + mask + 1, std::memory_order_release);
+        }
+        return n;
+    }
+
+    T pop() {
+        /*! Pop the oldest entry from the queue.
+        @return the entry, or the value set by setInvalidValue() if the queue
+        is empty
+        */
+        T ent = bad;
+        tryPop(ent);
+        return ent;
+    }
+
+    void setInvalidValue(T &entryInvalidValue) {
+        /*! Set the value that's given back by pop(), if the queue is empty.
+        Must be called before the queue is shared between threads.
+        * @param entryInvalidValue The value that is given back in case an
+        invalid operation (e.g. read from an empty queue) is tried.
+        */
+        bad = entryInvalidValue;
+    }
+
+    bool isEmpty() const {
+        /*! Check, if queue is empty.
+        @return true: queue empty, false: not empty.
+        */
+        return length() == 0;
+    }
+
+    unsigned int length() const {
+        /*! Check number of queue entries, a snapshot while other threads are
+        active. Entries that are being pushed or popped at the moment are
+        counted.
+        @return number of entries in the queue.
+        */
+        size_t d = dequeuePos.load(std::memory_order_acquire);
+        long len = diff(enqueuePos.load(std::memory_order_acquire), d);
+        if (len < 0)
+            return 0;
+        return len > (long)(mask + 1) ? (unsigned int)(mask + 1) : (unsigned int)len;
+    }
+
+    unsigned int capacity() const {
+        /*! Maximum number of entries
+        @return the maximum number of entries, a power of two */
+        return cells ? (unsigned int)(mask + 1) : 0;
+    }
+
+    unsigned int peak() const {
+        /*! Check the maxiumum number of entries that have been in the queue.
+        @return max number of queue entries.
+         */
+        return peakSize.load(std::memory_order_relaxed);
+    }
+};
+
+}  // namespace ustd
@@ -59,6 +59,15 @@ A Platform sets USTD_FEATURE_MEMORY to one of the above _MEM_ defines.
 
 // Network:
 #define USTD_FEATURE_NETWORK
+
+// C++ standard library (<iterator>, <atomic>, ...) is available:
+#define USTD_FEATURE_STL
+
+// Several cores or threads can access shared data, std::atomic is available:
+#define USTD_FEATURE_ATOMIC
+
+// Constant data must be placed in flash with PROGMEM and read with pgm_read (AVR):
+#define USTD_FEATURE_PROGMEM
 */
 
 // Compatibility-1
@@ -84,6 +93,7 @@ A Platform sets USTD_FEATURE_MEMORY to one of the above _MEM_ defines.
 #define KNOWN_PLATFORM 1
 #define USTD_FEATURE_MEMORY 512
 #define USTD_FEATURE_EEPROM
+#define USTD_FEATURE_PROGMEM
 #include <Arduino.h>
 #include <SoftwareSerial.h>
 #endif  // ATTINY
@@ -96,6 +106,7 @@ A Platform sets USTD_FEATURE_MEMORY to one of the above _MEM_ defines.
 #define KNOWN_PLATFORM 1
 #define USTD_FEATURE_MEMORY 2048
 #define USTD_FEATURE_EEPROM
+#define USTD_FEATURE_PROGMEM
 #define __ARDUINO__ 1
 #include <Arduino.h>
 #include <new.h>  // New Arduino core new operator
@@ -109,6 +120,7 @@ A Platform sets USTD_FEATURE_MEMORY to one of the above _MEM_ defines.
 #define KNOWN_PLATFORM 1
 #define USTD_FEATURE_MEMORY 8192
 #define USTD_FEATURE_EEPROM
+#define USTD_FEATURE_PROGMEM
 #define __ARDUINO__ 1
 #include <Arduino.h>
 #include <new.h>  // New Arduino core new operator
@@ -133,6 +145,8 @@ A Platform sets USTD_FEATURE_MEMORY to one of the above _MEM_ defines.
 #define KNOWN_PLATFORM 1
 #define USTD_FEATURE_MEMORY 264000
 #define USTD_FEATURE_SUPPORTS_NEW_OPERATOR
+#define USTD_FEATURE_STL
+#define USTD_FEATURE_ATOMIC
 #include "pico/stdlib.h"
 #include "stdlib.h"
 #define __ARM__ 1
@@ -169,6 +183,7 @@ A Platform sets USTD_FEATURE_MEMORY to one of the above _MEM_ defines.
 #endif
 #define KNOWN_PLATFORM 1
 #define USTD_FEATURE_MEMORY 80000
+#define USTD_FEATURE_STL
 #include <ESP8266WiFi.h>
 #define USTD_FEATURE_NETWORK
 #include <time.h>       // time() ctime()
@@ -255,6 +270,8 @@ A Platform sets USTD_FEATURE_MEMORY to one of the above _MEM_ defines.
 #define __TENSILICA__
 #endif
 #define USTD_FEATURE_MEMORY 320000
+#define USTD_FEATURE_STL
+#define USTD_FEATURE_ATOMIC
 #include <WiFi.h>
 #define USTD_FEATURE_NETWORK
 #include <time.h>      // time() ctime()
@@ -346,6 +363,8 @@ inline unsigned long millis() {
 #define USTD_FEATURE_SYSTEMCLOCK
 #define USTD_FEATURE_CLK_READ
 #define USTD_FEATURE_CLK_SET
+#define USTD_FEATURE_STL
+#define USTD_FEATURE_ATOMIC
 
 // ------------- Compatibility libs for Unixoids --------------
 /*
@@ -0,0 +1,271 @@
+// ustd_pool.h - fixed-block object pool
+
+#pragma once
+
+#include "ustd_memory.h"
+
+namespace ustd {
+
+namespace details {
+
+template <typename T> union poolSlot {
+    // a free slot holds the free list link, a used slot the object
+    poolSlot *next;
+    alignas(T) unsigned char obj[sizeof(T)];
+};
+
+template <typename T, unsigned int N> class poolStorage {
+  protected:
+    poolSlot<T> store[N];
+
+    poolStorage(unsigned int) {
+    }
+    poolSlot<T> *slots() {
+        return store;
+    }
+    const poolSlot<T> *slots() const {
+        return store;
+    }
+    unsigned int slotCount() const {
+        return N;
+    }
+};
+
+template <typename T> class poolStorage<T, 0> {
+  protected:
+    poolSlot<T> *store;
+    unsigned int count;
+
+    poolStorage(unsigned int count) : count(count) {
+        store = (poolSlot<T> *)malloc(count * sizeof(poolSlot<T>));
+        if (store == nullptr)
+            this->count = 0;
+    }
+    ~poolStorage() {
+        if (store != nullptr)
+            free(store);
+    }
+    poolSlot<T> *slots() {
+        return store;
+    }
+    const poolSlot<T> *slots() const {
+        return store;
+    }
+    unsigned int slotCount() const {
+        return count;
+    }
+};
+
+}  // namespace details
+
+/*! \brief Fixed-block object pool with O(1) allocation and free.
+
+ustd_pool.h provides a pool of equally sized blocks for objects of type T, e.g.
+message records or timer nodes. Allocation and free are O(1) and never fragment
+memory: free blocks are kept in an intrusive free list, the link is stored
+inside the free block itself, so there is no per-block overhead.
+
+The storage for the blocks is either part of the pool object (N > 0, no heap
+usage, e.g. a global pool in .bss) or allocated once from the heap (N = 0,
+capacity given at construction).
+
+The pool does not track which blocks hold live objects, all objects must be
+destroyed before the pool.
+
+Make sure to provide the <a
+href="https://github.com/muwerk/ustd/blob/master/README.md">required platform
+define</a> before including ustd headers.
+
+## An example:
+
+~~~{.cpp}
+#define __ESP__ 1   // Platform defines required, see doc, mainpage.
+#include <ustd_pool.h>
+
+struct timerNode {
+    unsigned long due;
+    int id;
+    timerNode(unsigned long due, int id) : due(due), id(id) {}
+};
+
+ustd::pool<timerNode, 16> timers;  // storage for 16 nodes, no heap
+ustd::pool<timerNode> heapTimers(64);  // storage for 64 nodes, allocated once
+
+timerNode *t = timers.construct(millis() + 100, 1);  // nullptr, if the pool is exhausted
+...
+timers.destroy(t);
+printf("%u free, peak %u\n", timers.freeCount(), timers.peak());
+~~~
+ */
+template <typename T, unsigned int N = 0> class pool : private details::poolStorage<T, N> {
+  private:
+    typedef details::poolSlot<T> slot;
+    slot *freeList;
+    unsigned int unused;  // slots from here on were never handed out
+    unsigned int size;
+    unsigned int peakSize;
+
+  public:
+    explicit pool(unsigned int count = N)
+        : details::poolStorage<T, N>(count), freeList(nullptr), unused(0), size(0), peakSize(0) {
+        /*! Constructs a pool. The free list is built lazily, so construction
+        is O(1) regardless of the capacity.
+        @param count number of blocks for heap pools (N = 0), ignored if N > 0.
+        Check capacity() for heap allocation failure. */
+    }
+
+    pool(const pool &) = delete;
+    pool &operator=(const pool &) = delete;
+
+    void *allocate() {
+        /*! Allocate one uninitialized block for a T in O(1)
+        @return pointer to the block or nullptr, if the pool is exhausted */
+        slot *s;
+        if (freeList != nullptr) {
+            s = freeList;
+            freeList = s->next;
+        } else if (unused < this->slotCount()) {
+            s = this->slots() + unused;
+            ++unused;
+        } else {
+            return nullptr;
+        }
+        ++size;
+        if (size > peakSize)
+            peakSize = size;
+        return s->obj;
+    }
+
+    void deallocate(void *p) {
+        /*! Return block p, obtained from allocate(), to the pool in O(1). The
+        object in the block must have been destroyed.
+        @param p block to free, nullptr is ignored */
+        if (p == nullptr)
+            return;
+#if defined(__UNIXOID__)
+        assert(owns(p));
+#endif
+        slot *s = (slot *)p;
+        s->next = freeList;
+        freeList = s;
+        --size;
+    }
+
+    template <typename... Args> T *construct(Args &&...args) {
+        /*! Allocate a block and construct a T from args in it
+        @param args constructor arguments for the new object
+        @return pointer to the new object or nullptr, if the pool is exhausted */
+        void *p = allocate();
+        if (p == nullptr)
+            return nullptr;
+        return ::new (p) T(static_cast<Args &&>(args)...);
+    }
+
+    void destroy(T *obj) {
+        /*! Destroy an object created with construct() and free its block
+        @param obj object to destroy, nullptr is ignored */
+        if (obj == nullptr)
+            return;
+        obj->~T();
+        deallocate(obj);
+    }
+
+    bool owns(const void *p) const {
+        /*! Check, if p points to a block of this pool
+        @return true, if p is a block of the pool */
+        const unsigned char *first = (const unsigned char *)this->slots();
+        const unsigned char *b = (const unsigned char *)p;
+        return b >= first && b < first + this->slotCount() * sizeof(slot) &&
+               (b - first) % sizeof(slot) == 0;
+    }
+
+    static constexpr size_t blockSize() {
+        /*! Size of a pool block in bytes, at least sizeof(T)
+        @return block size */
+        return sizeof(slot);
+    }
+
+    unsigned int capacity() const {
+        /*! Number of blocks of the pool
+        @return N, or the count given at construction for heap pools (0, if
+        the heap allocation failed) */
+        return this->slotCount();
+    }
+
+    unsigned int freeCount() const {
+        /*! Number of blocks that are available for allocation
+        @return free blocks */
+        return this->slotCount() - size;
+    }
+
+    unsigned int length() const {
+        /*! Number of blocks in use
+        @return allocated blocks */
+        return size;
+    }
+
+    bool isEmpty() const {
+        /*! Check, if no blocks are in use
+        @return true, if all blocks are free */
+        return size == 0;
+    }
+
+    unsigned int peak() const {
+        /*! Get the maximum number of blocks that were in use at the same time,
+        see \ref ustd::queue::peak().
+        @return peak number of blocks in use */
+        return peakSize;
+    }
+};
+
+/*! \brief Allocator adapter to use a \ref ustd::pool with ustd containers.
+
+Each container allocation takes one pool block, so the pool must hold blocks
+that are large enough for the complete container memory. This fits containers
+with a fixed allocation, e.g. queues or static-mode arrays (startSize ==
+maxSize, incSize = 0). Requests larger than Pool::blockSize() fail.
+
+~~~{.cpp}
+typedef ustd::pool<int[32], 4> bufferPool;  // four buffers for 32 ints each
+bufferPool buffers;
+
+ustd::queue<int, ustd::poolAllocator<bufferPool>> que(32, ustd::poolAllocator<bufferPool>(buffers));
+~~~
+ */
+template <typename Pool> class poolAllocator {
+  private:
+    Pool *pl;
+
+  public:
+    poolAllocator(Pool &pl) : pl(&pl) {
+        /*! Construct an allocator for pool pl, pl must outlive all containers
+        that use the allocator. */
+    }
+
+    void *allocate(size_t bytes) {
+        /*! Allocate one block of the pool
+        @return pointer to a block, or nullptr if the pool is exhausted or
+        bytes > Pool::blockSize() */
+        if (bytes > Pool::blockSize())
+            return nullptr;
+        return pl->allocate();
+    }
+
+    void deallocate(void *p, size_t) {
+        /*! Return block p to the pool */
+        pl->deallocate(p);
+    }
+
+    void *reallocate(void *p, size_t, size_t newBytes) {
+        /*! Blocks can't be resized, but p is kept, as long as newBytes fits
+        @return p, a new block for p == nullptr, or nullptr if newBytes is too
+        large */
+        if (newBytes > Pool::blockSize())
+            return nullptr;
+        if (p == nullptr)
+            return pl->allocate();
+        return p;
+    }
+};
+
+}  // namespace ustd
@@ -2,18 +2,64 @@
 
 #pragma once
 
+#include "ustd_memory.h"
+#include "ustd_span.h"
+
 namespace ustd {
 
-// Helper class for queue iterators:
+// Helper class for queue iterators, random access over the ring in queue order:
 template <typename T> class queueIterator {
   private:
     T *values_ptr;
-    unsigned int position;
+    unsigned int start;     // ring position of the oldest entry
+    unsigned int position;  // logical index relative to start
     unsigned int maxSize;
+    unsigned int mask;  // maxSize - 1 for power-of-two sizes, else 0
+
+    unsigned int wrap(unsigned int i) const {
+        return mask ? i & mask : i % maxSize;
+    }
 
   public:
-    queueIterator(T *values_ptr, unsigned int p, unsigned int maxSize)
-        : values_ptr{values_ptr}, position{p}, maxSize(maxSize) {
+    typedef typename details::removeConst<T>::type value_type;
+    typedef long difference_type;
+    typedef T *pointer;
+    typedef T &reference;
+
+    queueIterator() : values_ptr{nullptr}, start{0}, position{0}, maxSize{1}, mask{0} {
+    }
+
+    queueIterator(T *values_ptr, unsigned int start, unsigned int p, unsigned int maxSize,
+                  unsigned int mask = 0)
+        : values_ptr{values_ptr}, start{start}, position{p}, maxSize(maxSize ? maxSize : 1),
+          mask(mask) {
+    }
+
+    template <typename U>
+    queueIterator(const queueIterator<U> &other)
+        : values_ptr{other.base()}, start{other.startPosition()}, position{other.index()},
+          maxSize{other.ringSize()}, mask{other.ringMask()} {
+        // conversion from iterator to const_iterator
+    }
+
+    T *base() const {
+        return values_ptr;
+    }
+
+    unsigned int startPosition() const {
+        return start;
+    }
+
+    unsigned int index() const {
+        return position;
+    }
+
+    unsigned int ringSize() const {
+        return maxSize;
+    }
+
+    unsigned int ringMask() const {
+        return mask;
     }
 
     bool operator!=(const queueIterator<T> &other) const {
@@ -24,13 +70,80 @@ template <typename T> class queueIterator {
         return position == other.position;
     }
 
+    bool operator<(const queueIterator<T> &other) const {
+        return position < other.position;
+    }
+
+    bool operator>(const queueIterator<T> &other) const {
+        return position > other.position;
+    }
+
+    bool operator<=(const queueIterator<T> &other) const {
+        return position <= other.position;
+    }
+
+    bool operator>=(const queueIterator<T> &other) const {
+        return position >= other.position;
+    }
+
     queueIterator &operator++() {
-        position = (position + 1) % maxSize;
+        ++position;
+        return *this;
+    }
+
+    queueIterator operator++(int) {
+        queueIterator it(*this);
+        ++position;
+        return it;
+    }
+
+    queueIterator &operator--() {
+        --position;
         return *this;
     }
 
+    queueIterator operator--(int) {
+        queueIterator it(*this);
+        --position;
+        return it;
+    }
+
+    queueIterator &operator+=(difference_type n) {
+        position += n;
+        return *this;
+    }
+
+    queueIterator &operator-=(difference_type n) {
+        position -= n;
+        return *this;
+    }
+
+    queueIterator operator+(difference_type n) const {
+        return queueIterator(values_ptr, start, position + n, maxSize, mask);
+    }
+
+    friend queueIterator operator+(difference_type n, const queueIterator &it) {
+        return it + n;
+    }
+
+    queueIterator operator-(difference_type n) const {
+        return queueIterator(values_ptr, start, position - n, maxSize, mask);
+    }
+
+    difference_type operator-(const queueIterator<T> &other) const {
+        return (difference_type)position - (difference_type)other.position;
+    }
+
     T &operator*() const {
-        return *(values_ptr + position);
+        return *(values_ptr + wrap(start + position));
+    }
+
+    T *operator->() const {
+        return values_ptr + wrap(start + position);
+    }
+
+    T &operator[](difference_type n) const {
+        return *(values_ptr + wrap(start + position + n));
     }
 };
 
@@ -79,50 +192,166 @@ w1=que.pop();
 // Queue is now empty.
 
 printf("%d %d, len=%d\n",w0,w1,que.length());
+
+## Batch and zero-copy access
+
+~~~{.cpp}
+queue<unsigned char> tx(256);
+tx.pushN(data, len);  // at most two block copies
+
+ustd::span<unsigned char> a, b;
+tx.readRegions(a, b);  // queued bytes in place, oldest in a
+int n = write(fd, a.data(), a.length());
+if (n > 0)
+    tx.commitRead(n);  // remove what was written
+
+queue<unsigned char> rx(256);
+rx.writeRegions(a, b);  // free space in place
+n = read(fd, a.data(), a.length());
+if (n > 0)
+    rx.commitWrite(n);
+~~~
+
+## Overwrite mode
+
+For streams where the newest entries matter, e.g. sensor samples, the queue
+can keep a rolling window: with setOverwrite(true) push() drops the oldest
+entry if the queue is full, dropped() counts the lost entries.
+
+~~~{.cpp}
+queue<float> samples(32);
+samples.setOverwrite(true);
+samples.push(readSensor());  // never fails, keeps the newest 32 samples
+printf("peak %u, dropped %u\n", samples.peak(), samples.dropped());
+~~~
+
+## Power-of-two sizes
+
+If maxQueueSize is a power of two (2, 4, 8, ... 128, ...), the queue wraps its
+indices with a bit mask instead of a modulo operation. The read and write
+indices run freely and the length is their difference, so push() and pop()
+need neither a division nor a separate size counter. This is the fastest
+configuration, e.g. for serial buffers that are filled by an interrupt handler
+on AVR or Cortex-M0, which have no hardware division. Other sizes wrap the
+indices with a comparison.
+
+~~~{.cpp}
+queue<unsigned char> rxBuffer(64);  // power of two: masked indices
+~~~
 */
 
-template <class T> class queue {
+template <class T, class Alloc = mallocAllocator> class queue {
   private:
     T *que;
     unsigned int peakSize;
+    unsigned int droppedCount;
+    bool overwrite;
     unsigned int maxSize;
-    unsigned int size;
-    unsigned int quePtr0;
-    unsigned int quePtr1;
+    unsigned int size;     // only used if mask == 0
+    unsigned int quePtr0;  // read index, free-running if mask != 0
+    unsigned int quePtr1;  // write index, free-running if mask != 0
+    unsigned int mask;     // maxSize - 1 for power-of-two sizes, else 0
     T bad = {};
+    Alloc alloc;
+
+    static unsigned int maskFor(unsigned int n) {
+        return n > 1 && (n & (n - 1)) == 0 ? n - 1 : 0;
+    }
+
+    unsigned int first() const {
+        // ring position of the oldest entry
+        return mask ? quePtr0 & mask : quePtr0;
+    }
+
+    unsigned int count() const {
+        return mask ? quePtr1 - quePtr0 : size;
+    }
+
+    unsigned int next() const {
+        // ring position of the next free slot
+        return mask ? quePtr1 & mask : quePtr1;
+    }
+
+    void advanceRead(unsigned int n) {
+        quePtr0 += n;
+        if (mask == 0) {
+            if (quePtr0 >= maxSize)
+                quePtr0 -= maxSize;
+            size -= n;
+        }
+    }
+
+    void advanceWrite(unsigned int n) {
+        quePtr1 += n;
+        if (mask == 0) {
+            if (quePtr1 >= maxSize)
+                quePtr1 -= maxSize;
+            size += n;
+        }
+        if (count() > peakSize)
+            peakSize = count();
+    }
+
+    void dropOldest(unsigned int n) {
+        unsigned int r = first();
+        unsigned int n0 = maxSize - r < n ? maxSize - r : n;
+        details::destroyRange(que + r, n0);
+        details::destroyRange(que, n - n0);
+        advanceRead(n);
+    }
+
+    void destroyAll() {
+        unsigned int n = count();
+        unsigned int start = first();
+        unsigned int n0 = maxSize - start < n ? maxSize - start : n;
+        details::destroyRange(que + start, n0);
+        details::destroyRange(que, n - n0);
+    }
 
   public:
-    queue(unsigned int maxQueueSize) : maxSize(maxQueueSize) {
+    queue(unsigned int maxQueueSize, const Alloc &alloc = Alloc())
+        : maxSize(maxQueueSize), alloc(alloc) {
         /*! Constructs a queue object
         @param maxQueueSize The maximum number of entries, the queue
         can hold.
+        @param alloc Allocator for the queue memory, see
+        \ref ustd::mallocAllocator.
         */
         quePtr0 = 0;
         quePtr1 = 0;
         size = 0;
         peakSize = 0;
-        que = (T *)malloc(sizeof(T) * maxSize);
+        droppedCount = 0;
+        overwrite = false;
+        que = (T *)this->alloc.allocate(sizeof(T) * maxSize);
         if (que == nullptr)
             maxSize = 0;
+        mask = maskFor(maxSize);
     }
 
-    queue(const queue &qu) {
+    queue(const queue &qu) : alloc(qu.alloc) {
         peakSize = qu.peakSize;
+        droppedCount = qu.droppedCount;
+        overwrite = qu.overwrite;
         maxSize = qu.maxSize;
         size = qu.size;
         quePtr0 = qu.quePtr0;
         quePtr1 = qu.quePtr1;
+        mask = qu.mask;
         bad = qu.bad;
-        que = (T *)malloc(sizeof(T) * maxSize);
+        que = (T *)alloc.allocate(sizeof(T) * maxSize);
         if (que == nullptr) {
             maxSize = 0;
             size = 0;
+            quePtr0 = quePtr1 = 0;
+            mask = 0;
         } else {
-            unsigned int in = quePtr0;
-            for (unsigned int i = 0; i < size; i++) {
-                que[in] = qu.que[in];
-                in = (in + 1) % maxSize;
-            }
+            // copy the (at most two) contiguous segments of the ring
+            unsigned int n = count();
+            unsigned int start = first();
+            unsigned int n0 = maxSize - start < n ? maxSize - start : n;
+            details::copyRange(que + start, qu.que + start, n0);
+            details::copyRange(que, qu.que, n - n0);
         }
     }
 
@@ -131,7 +360,8 @@ template <class T> class queue {
         Deallocate the queue structure.
         */
         if (que != nullptr) {
-            free(que);
+            destroyAll();
+            alloc.deallocate(que, sizeof(T) * maxSize);
             que = nullptr;
         }
     }
@@ -139,38 +369,62 @@ template <class T> class queue {
     // iterators
     queueIterator<T> begin() {
         /*! Iterator support: begin() */
-        return queueIterator<T>(que, quePtr0, maxSize);
+        return queueIterator<T>(que, first(), 0, maxSize, mask);
     }
     queueIterator<T> end() {
         /*! Iterator support: end() */
-        return queueIterator<T>(que, (quePtr0 + size) % maxSize, maxSize);
+        return queueIterator<T>(que, first(), count(), maxSize, mask);
     }
 
     queueIterator<const T> begin() const {
         /*! Iterator support: begin() */
-        return queueIterator<const T>(que, quePtr0, maxSize);
+        return queueIterator<const T>(que, first(), 0, maxSize, mask);
     }
 
     queueIterator<const T> end() const {
         /*! Iterator support: end() */
-        return queueIterator<const T>(que, (quePtr0 + size) % maxSize, maxSize);
+        return queueIterator<const T>(que, first(), count(), maxSize, mask);
     }
 
     void getInternalStartStopPtrs(unsigned int *p0, unsigned int *p1) {
-        *p0 = quePtr0;
-        *p1 = quePtr1;
+        *p0 = first();
+        *p1 = next();
     }
 
     bool push(T ent) {
         /*! Push a new entry into the queue.
         @param ent T element
-        @return true on success, false if queue is full.
+        @return true on success, false if queue is full. In overwrite mode
+        (see setOverwrite()) the oldest entry is dropped instead.
         */
+        if (mask) {
+            unsigned int n = quePtr1 - quePtr0;
+            if (n > mask) {
+                if (!overwrite)
+                    return false;
+                details::destroyRange(que + (quePtr0 & mask), 1);
+                ++quePtr0;
+                ++droppedCount;
+                --n;
+            }
+            ::new (static_cast<void *>(que + (quePtr1 & mask))) T(static_cast<T &&>(ent));
+            ++quePtr1;
+            if (n >= peakSize)
+                peakSize = n + 1;
+            return true;
+        }
         if (size >= maxSize) {
-            return false;
+            if (!overwrite || maxSize == 0)
+                return false;
+            details::destroyRange(que + quePtr0, 1);
+            if (++quePtr0 == maxSize)
+                quePtr0 = 0;
+            --size;
+            ++droppedCount;
         }
-        que[quePtr1] = ent;
-        quePtr1 = (quePtr1 + 1) % maxSize;
+        ::new (static_cast<void *>(que + quePtr1)) T(static_cast<T &&>(ent));
+        if (++quePtr1 == maxSize)
+            quePtr1 = 0;
         ++size;
         if (size > peakSize) {
             peakSize = size;
@@ -182,14 +436,130 @@ template <class T> class queue {
         /*! Pop the oldest entry from the queue.
         @return badEntry if queue is empty, or T element otherwise.
         */
+        if (mask) {
+            if (quePtr0 == quePtr1)
+                return bad;
+            T *p = que + (quePtr0 & mask);
+            T ent = static_cast<T &&>(*p);
+            details::destroyRange(p, 1);
+            ++quePtr0;
+            return ent;
+        }
         if (size == 0)
             return bad;
-        T ent = que[quePtr0];
-        quePtr0 = (quePtr0 + 1) % maxSize;
+        T ent = static_cast<T &&>(que[quePtr0]);
+        details::destroyRange(que + quePtr0, 1);
+        if (++quePtr0 == maxSize)
+            quePtr0 = 0;
         --size;
         return ent;
     }
 
+    unsigned int pushN(const T *entries, unsigned int count) {
+        /*! Push up to count entries with at most two block copies.
+        @param entries entries to push, entries[0] first
+        @param count number of entries
+        @return number of entries pushed, less than count if the queue is full.
+        In overwrite mode all entries are pushed and the oldest entries are
+        dropped to make room. If count exceeds the queue size, only the newest
+        entries are kept.
+        */
+        unsigned int free = maxSize - this->count();
+        if (count > free && overwrite && maxSize) {
+            if (count > maxSize) {
+                droppedCount += count - maxSize;
+                entries += count - maxSize;
+                count = maxSize;
+            }
+            droppedCount += count - free;
+            dropOldest(count - free);
+            free = count;
+        }
+        if (count > free)
+            count = free;
+        unsigned int w = next();
+        unsigned int n0 = maxSize - w < count ? maxSize - w : count;
+        details::copyRange(que + w, entries, n0);
+        details::copyRange(que, entries + n0, count - n0);
+        advanceWrite(count);
+        return count;
+    }
+
+    unsigned int popN(T *entries, unsigned int count) {
+        /*! Pop up to count of the oldest entries with at most two block moves.
+        @param entries receives the entries, oldest first
+        @param count maximum number of entries
+        @return number of entries popped, 0 if the queue is empty
+        */
+        if (count > this->count())
+            count = this->count();
+        unsigned int r = first();
+        unsigned int n0 = maxSize - r < count ? maxSize - r : count;
+        details::moveOut(entries, que + r, n0);
+        details::moveOut(entries + n0, que, count - n0);
+        advanceRead(count);
+        return count;
+    }
+
+    unsigned int readRegions(span<T> &first, span<T> &second) {
+        /*! Access the entries in place as up to two contiguous regions, e.g.
+        to hand them to write() or DMA without copying. The entries stay in
+        the queue until commitRead() is called.
+        @param first receives the oldest entries
+        @param second receives the entries that wrap around to the start of
+        the ring buffer, empty if there are none
+        @return number of entries in both regions, length() */
+        unsigned int n = count();
+        unsigned int r = this->first();
+        unsigned int n0 = maxSize - r < n ? maxSize - r : n;
+        first = span<T>(que + r, n0);
+        second = span<T>(que, n - n0);
+        return n;
+    }
+
+    bool commitRead(unsigned int n) {
+        /*! Remove the n oldest entries after they were consumed with
+        readRegions().
+        @param n number of entries to remove
+        @return true on success, false if n > length() */
+        if (n > count())
+            return false;
+        dropOldest(n);
+        return true;
+    }
+
+    unsigned int writeRegions(span<T> &first, span<T> &second) {
+        /*! Free space of the queue as up to two contiguous regions, e.g. for
+        read() or DMA directly into the ring buffer. Written entries are added
+        to the queue by commitWrite(). Only for trivially copyable T, since the
+        regions are uninitialized memory.
+        @param first receives the region for the next entries
+        @param second receives the region that wraps around to the start of
+        the ring buffer, empty if there is none
+        @return number of free entries in both regions */
+        static_assert(USTD_IS_TRIVIALLY_COPYABLE(T),
+                      "writeRegions() requires trivially copyable entries");
+        unsigned int free = maxSize - count();
+        unsigned int w = next();
+        unsigned int n0 = maxSize - w < free ? maxSize - w : free;
+        first = span<T>(que + w, n0);
+        second = span<T>(que, free - n0);
+        return free;
+    }
+
+    bool commitWrite(unsigned int n) {
+        /*! Add n entries that were written into the regions of writeRegions()
+        to the queue.
+        @param n number of written entries, first region first
+        @return true on success, false if n exceeds the free space */
+        static_assert(USTD_IS_TRIVIALLY_COPYABLE(T),
+                      "commitWrite() requires trivially copyable entries");
+        if (n > maxSize - count())
+            return false;
+        advanceWrite(n);
+        return true;
+    }
+
     void setInvalidValue(T &entryInvalidValue) {
         /*! Set the value that's given back, if read from an empty
         queue is requested. By default, an entry all set to zero is given
@@ -205,7 +575,7 @@ template <class T> class queue {
         /*! Check, if queue is empty.
         @return true: queue empty, false: not empty.
         */
-        if (size == 0)
+        if (count() == 0)
             return true;
         else
             return false;
@@ -215,7 +585,7 @@ template <class T> class queue {
         /*! Check number of queue entries.
         @return number of entries in the queue.
         */
-        return (size);
+        return count();
     }
 
     unsigned int peak() {
@@ -224,5 +594,48 @@ template <class T> class queue {
          */
         return (peakSize);
     }
+
+    void setOverwrite(bool enable) {
+        /*! Select the behaviour of push() and pushN() on a full queue.
+        @param enable false (default): push fails, the new entry is discarded.
+        true: the oldest entry is dropped to make room, the queue keeps a
+        rolling window of the newest entries at constant cost per push.
+        */
+        overwrite = enable;
+    }
+
+    bool isOverwrite() {
+        /*! Check the overwrite mode, see setOverwrite().
+        @return true if push() drops the oldest entry on a full queue.
+        */
+        return overwrite;
+    }
+
+    unsigned int dropped() {
+        /*! Number of entries that were dropped in overwrite mode to make room
+        for new entries.
+        @return number of dropped entries since construction or the last
+        resetDropped().
+        */
+        return droppedCount;
+    }
+
+    void resetDropped() {
+        /*! Reset the dropped() counter to zero. */
+        droppedCount = 0;
+    }
 };
 }  // namespace ustd
+
+#if defined(USTD_FEATURE_STL)
+#include <iterator>
+namespace std {
+template <typename T> struct iterator_traits<ustd::queueIterator<T>> {
+    typedef random_access_iterator_tag iterator_category;
+    typedef typename ustd::queueIterator<T>::value_type value_type;
+    typedef typename ustd::queueIterator<T>::difference_type difference_type;
+    typedef typename ustd::queueIterator<T>::pointer pointer;
+    typedef typename ustd::queueIterator<T>::reference reference;
+};
+}  // namespace std
+#endif
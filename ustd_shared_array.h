@@ -0,0 +1,503 @@
+// ustd_shared_array.h - copy-on-write array with O(1) copies
+
+#pragma once
+
+#include "ustd_array.h"
+#include "ustd_span.h"
+
+#if defined(USTD_FEATURE_ATOMIC)
+#include <atomic>
+#endif
+
+namespace ustd {
+
+namespace details {
+
+#if defined(USTD_FEATURE_ATOMIC)
+typedef std::atomic<unsigned int> refCount;
+#else
+typedef unsigned int refCount;  // single core: a plain counter is sufficient
+#endif
+
+inline void refAcquire(refCount &refs) {
+#if defined(USTD_FEATURE_ATOMIC)
+    refs.fetch_add(1, std::memory_order_relaxed);
+#else
+    ++refs;
+#endif
+}
+
+inline bool refRelease(refCount &refs) {
+    // true, if the last reference was released
+#if defined(USTD_FEATURE_ATOMIC)
+    return refs.fetch_sub(1, std::memory_order_acq_rel) == 1;
+#else
+    return --refs == 0;
+#endif
+}
+
+inline unsigned int refLoad(const refCount &refs) {
+#if defined(USTD_FEATURE_ATOMIC)
+    return refs.load(std::memory_order_acquire);
+#else
+    return refs;
+#endif
+}
+
+// Check, if the copy constructor of container C succeeded, specialized per container
+template <typename C> struct cowCopy;
+
+template <typename T, typename A> struct cowCopy<array<T, A>> {
+    static bool complete(const array<T, A> &orig, const array<T, A> &copy) {
+        // the array copy constructor leaves the copy empty, if allocation failed
+        return orig.length() == copy.length();
+    }
+};
+
+// Container C together with the number of handles that share it
+template <typename C> struct sharedBlock {
+    refCount refs;
+    bool escaped;  // a mutable reference into obj was handed out, copies must not share it
+    C obj;
+
+    template <typename... Args>
+    sharedBlock(const Args &...args) : refs(1), escaped(false), obj(args...) {
+    }
+};
+
+// Reference-counted handle of a container C, the container is copied on the
+// first mutable access while it is shared (copy-on-write).
+template <typename C, typename Alloc> class cowHandle {
+  private:
+    typedef sharedBlock<C> block;
+    block *blk;
+    Alloc alloc;
+
+    template <typename... Args> static block *create(Alloc &a, const Args &...args) {
+        void *p = a.allocate(sizeof(block));
+        if (p == nullptr)
+            return nullptr;
+        return ::new (p) block(args...);
+    }
+
+    static void destroy(Alloc &a, block *b) {
+        b->~block();
+        a.deallocate(b, sizeof(block));
+    }
+
+    static block *clone(Alloc &a, const block *b) {
+        // private copy of the container of b, nullptr if out of memory
+        block *copy = create(a, b->obj);
+        if (copy != nullptr && !cowCopy<C>::complete(b->obj, copy->obj)) {
+            destroy(a, copy);
+            return nullptr;
+        }
+        return copy;
+    }
+
+    static block *share(Alloc &a, block *b) {
+        // block for a new handle that copies a handle of b
+        if (b == nullptr)
+            return nullptr;
+        if (b->escaped)
+            return clone(a, b);
+        refAcquire(b->refs);
+        return b;
+    }
+
+    void release() {
+        if (blk != nullptr && refRelease(blk->refs))
+            destroy(alloc, blk);
+        blk = nullptr;
+    }
+
+  public:
+    template <typename... Args>
+    cowHandle(const Alloc &alloc, const Args &...args) : blk(nullptr), alloc(alloc) {
+        blk = create(this->alloc, args...);
+    }
+
+    cowHandle(const cowHandle &other) : blk(nullptr), alloc(other.alloc) {
+        blk = share(alloc, other.blk);
+    }
+
+    cowHandle(cowHandle &&other) : blk(other.blk), alloc(other.alloc) {
+        other.blk = nullptr;
+    }
+
+    cowHandle &operator=(const cowHandle &other) {
+        if (blk != other.blk) {
+            Alloc a = other.alloc;
+            block *b = share(a, other.blk);
+            release();
+            blk = b;
+            alloc = a;
+        }
+        return *this;
+    }
+
+    cowHandle &operator=(cowHandle &&other) {
+        if (this != &other) {
+            release();
+            blk = other.blk;
+            alloc = other.alloc;
+            other.blk = nullptr;
+        }
+        return *this;
+    }
+
+    ~cowHandle() {
+        release();
+    }
+
+    const C *get() const {
+        // shared container for reading, nullptr if there is none (out of
+        // memory or moved-from)
+        return blk != nullptr ? &blk->obj : nullptr;
+    }
+
+    bool detach() {
+        // make sure that this handle is the only owner of its container
+        if (blk == nullptr) {
+            // moved-from or out of memory: start over with an empty container,
+            // array and map take the same constructor arguments
+            blk = create(alloc, ARRAY_INIT_SIZE, ARRAY_MAX_SIZE, ARRAY_INC_SIZE, true,
+                         arrayGrowth(), alloc);
+            return blk != nullptr;
+        }
+        if (refLoad(blk->refs) == 1)
+            return true;
+        block *copy = clone(alloc, blk);
+        if (copy == nullptr)
+            return false;
+        release();
+        blk = copy;
+        return true;
+    }
+
+    C *mut() {
+        // unshared container for modification, nullptr if out of memory.
+        // References handed out by mutRef() are invalidated by modifications,
+        // so copies may share the container again.
+        if (!detach())
+            return nullptr;
+        blk->escaped = false;
+        return &blk->obj;
+    }
+
+    C *mutRef() {
+        // like mut(), for accesses that hand out references or pointers into
+        // the container: copies get their own container until the next mut()
+        if (!detach())
+            return nullptr;
+        blk->escaped = true;
+        return &blk->obj;
+    }
+
+    unsigned int useCount() const {
+        return blk != nullptr ? refLoad(blk->refs) : 0;
+    }
+};
+
+}  // namespace details
+
+/*! \brief Copy-on-write array with O(1) copies.
+
+ustd_shared_array.h provides an array with cheap value semantics: copies
+(pass by value, assignment, return) share the same entries and only increment
+a reference count. The entries are duplicated on the first modification of a
+shared copy, so every copy behaves like an independent \ref ustd::array.
+This is useful for data that is passed to several callbacks or subscribers
+and is rarely modified afterwards. \ref ustd::shared_map is the dictionary
+counterpart.
+
+The reference count is atomic on platforms with USTD_FEATURE_ATOMIC
+(Unixoids, ESP32, RP2040), so copies can be handed to other threads or cores.
+On single-core MCUs it is a plain counter: do not copy or release a
+shared_array concurrently in an interrupt handler there.
+
+Note that the non-const versions of operator[], data() and begin() are
+mutable accesses and create a private copy, if the entries are shared. Read
+through a const reference or view() to avoid unnecessary copies, and write
+single entries with set(). A modification
+fails (like an out-of-memory add()) if the private copy cannot be allocated.
+
+References, pointers and iterators obtained from these non-const accessors stay
+valid until the next modification (e.g. add() or set()): while they may exist,
+copies of the shared_array get their own entries immediately instead of
+sharing them, so writing through a reference never changes a copy. A moved-from shared_array is
+empty and can be reused, it starts over with the default allocation hints.
+
+Make sure to provide the <a
+href="https://github.com/muwerk/ustd/blob/master/README.md">required platform
+define</a> before including ustd headers.
+
+## An example:
+
+~~~{.cpp}
+#define __UNIXOID__ 1   // Platform defines required, see doc, mainpage.
+#include <ustd_shared_array.h>
+
+void subscriber(ustd::shared_array<int> samples) {  // O(1), no entries are copied
+    int s = 0;
+    for (auto v : samples.view())
+        s += v;
+}
+
+ustd::shared_array<int> samples;
+samples.add(1);
+samples.add(2);
+subscriber(samples);                     // shares the entries
+ustd::shared_array<int> scaled = samples;
+scaled[0] = 10;                          // scaled gets its own copy, samples[0] is still 1
+~~~
+ */
+template <typename T, typename Alloc = mallocAllocator> class shared_array {
+  private:
+    details::cowHandle<array<T, Alloc>, Alloc> handle;
+    T bad = {};
+
+  public:
+    shared_array(unsigned int startSize = ARRAY_INIT_SIZE, unsigned int maxSize = ARRAY_MAX_SIZE,
+                 unsigned int incSize = ARRAY_INC_SIZE, bool shrink = true,
+                 arrayGrowth growth = arrayGrowth(), const Alloc &alloc = Alloc())
+        : handle(alloc, startSize, maxSize, incSize, shrink, growth, alloc) {
+        /*!
+         * Constructs an empty shared_array, see \ref ustd::array::array() for
+         * the allocation hints.
+         * @param startSize The number of array entries that are allocated
+         * during object creation
+         * @param maxSize The maximal limit of records that will be allocated.
+         * @param incSize The number of array entries that are allocated as a
+         * chunk if the array needs to grow
+         * @param shrink Boolean indicating, if the array should deallocate
+         * memory, if the array size shrinks (due to erase()).
+         * @param growth Growth policy, see \ref ustd::arrayGrowth.
+         * @param alloc Allocator for the entries and the reference count, see
+         * \ref ustd::mallocAllocator.
+         */
+    }
+
+    shared_array(const T initarray[], unsigned int count, const Alloc &alloc = Alloc())
+        : handle(alloc, initarray, count, alloc) {
+        /*! construct shared_array with const T[] c-array of length count
+        @param initarray c-array of type T
+        @param count number of entries in initarray
+        @param alloc Allocator for the entries and the reference count */
+    }
+
+    span<const T> view() const {
+        /*! Read access to the shared entries without copying, e.g. for the
+        functions of \ref ustd_algorithm.h and \ref ustd_simd.h.
+        @return view of the entries, valid until this shared_array is modified
+        or destroyed */
+        const array<T, Alloc> *ar = handle.get();
+        return ar ? span<const T>(*ar) : span<const T>();
+    }
+
+    bool detach() {
+        /*! Make sure that the entries are not shared with other copies. This
+        is done automatically by all modifications.
+        @return true on success, false if the copy could not be allocated */
+        return handle.detach();
+    }
+
+    unsigned int useCount() const {
+        /*! Number of copies that share the entries
+        @return reference count, 0 if there are no entries (out of memory or
+        moved-from) */
+        return handle.useCount();
+    }
+
+    bool isShared() const {
+        /*! Check, if the entries are shared with another copy, in which case
+        the next modification copies them */
+        return handle.useCount() > 1;
+    }
+
+    arrayIterator<const T> begin() const {
+        /*! Iterator support: begin() */
+        const array<T, Alloc> *ar = handle.get();
+        return ar ? ar->begin() : arrayIterator<const T>();
+    }
+
+    arrayIterator<const T> end() const {
+        /*! Iterator support: end() */
+        const array<T, Alloc> *ar = handle.get();
+        return ar ? ar->end() : arrayIterator<const T>();
+    }
+
+    arrayIterator<T> begin() {
+        /*! Iterator support: begin(), detaches the entries for modification */
+        array<T, Alloc> *ar = handle.mutRef();
+        return ar ? ar->begin() : arrayIterator<T>();
+    }
+
+    arrayIterator<T> end() {
+        /*! Iterator support: end(), detaches the entries for modification */
+        array<T, Alloc> *ar = handle.mutRef();
+        return ar ? ar->end() : arrayIterator<T>();
+    }
+
+    bool resize(unsigned int newSize) {
+        /*! Change the array allocation size, see \ref ustd::array::resize() */
+        array<T, Alloc> *ar = handle.mut();
+        return ar ? ar->resize(newSize) : false;
+    }
+
+    void setInvalidValue(T &entryInvalidValue) {
+        /*! Set the value that's given back, if read of an invalid index is
+        requested, see \ref ustd::array::setInvalidValue() */
+        bad = entryInvalidValue;
+    }
+
+    int add(const T &entry) {
+        /*! Append an array element
+        @param entry array element to be appended
+        @return index of the new entry or -1 on error */
+        array<T, Alloc> *ar = handle.mut();
+        return ar ? ar->add(entry) : -1;
+    }
+
+    int add(T &&entry) {
+        /*! Append an array element by moving it into the array
+        @return index of the new entry or -1 on error */
+        array<T, Alloc> *ar = handle.mut();
+        return ar ? ar->add(static_cast<T &&>(entry)) : -1;
+    }
+
+    template <typename... Args> int emplace(Args &&...args) {
+        /*! Construct a new element in place at the end of the array
+        @return index of the new entry or -1 on error */
+        array<T, Alloc> *ar = handle.mut();
+        return ar ? ar->emplace(static_cast<Args &&>(args)...) : -1;
+    }
+
+    bool erase(unsigned int index) {
+        /*! Delete array element at given index, the order is kept
+        @return true on success */
+        array<T, Alloc> *ar = handle.mut();
+        return ar ? ar->erase(index) : false;
+    }
+
+    bool eraseUnordered(unsigned int index) {
+        /*! Delete array element at given index in O(1) by moving the last
+        entry into its place
+        @return true on success */
+        array<T, Alloc> *ar = handle.mut();
+        return ar ? ar->eraseUnordered(index) : false;
+    }
+
+    bool reserve(unsigned int count) {
+        /*! Make sure that count entries fit without reallocation
+        @return true on success */
+        array<T, Alloc> *ar = handle.mut();
+        return ar ? ar->reserve(count) : false;
+    }
+
+    bool insert(unsigned int index, const T *entries, unsigned int count) {
+        /*! Insert count entries before index, see \ref ustd::array::insert()
+        @return true on success */
+        array<T, Alloc> *ar = handle.mut();
+        return ar ? ar->insert(index, entries, count) : false;
+    }
+
+    bool addRange(const T *entries, unsigned int count) {
+        /*! Append count entries
+        @return true on success */
+        array<T, Alloc> *ar = handle.mut();
+        return ar ? ar->addRange(entries, count) : false;
+    }
+
+    bool eraseRange(unsigned int first, unsigned int count) {
+        /*! Delete count entries starting at first
+        @return true on success */
+        array<T, Alloc> *ar = handle.mut();
+        return ar ? ar->eraseRange(first, count) : false;
+    }
+
+    void clear() {
+        /*! Delete all array elements, but keep the allocated memory. */
+        array<T, Alloc> *ar = handle.mut();
+        if (ar)
+            ar->clear();
+    }
+
+    bool erase() {
+        /*! Delete all array elements. memory might be freed, if shrink=True
+         * during array creation. */
+        array<T, Alloc> *ar = handle.mut();
+        return ar ? ar->erase() : false;
+    }
+
+    T operator[](unsigned int i) const {
+        /*! Read content of array element at i without copying the entries,
+        a=mySharedArray[3] */
+        const array<T, Alloc> *ar = handle.get();
+        if (ar == nullptr || i >= ar->length()) {
+#if defined(__UNIXOID__)
+            assert(i < length());
+#endif
+            return bad;
+        }
+        return ar->data()[i];
+    }
+
+    T &operator[](unsigned int i) {
+        /*! Assign content of array element at i, e.g. mySharedArray[3]=3.
+        Detaches the entries, if they are shared. */
+        array<T, Alloc> *ar = handle.mutRef();
+        if (ar == nullptr)
+            return bad;
+        return (*ar)[i];
+    }
+
+    bool set(unsigned int i, const T &value) {
+        /*! Assign content of array element at i like the non-const operator[],
+        but without handing out a reference, so later copies still share the
+        entries.
+        @return true on success */
+        array<T, Alloc> *ar = handle.mut();
+        if (ar == nullptr)
+            return false;
+        (*ar)[i] = value;
+        return i < ar->length();
+    }
+
+    T *data() {
+        /*! Direct access to the contiguous entries, detaches them, if they are
+        shared.
+        @return pointer to the first entry, nullptr if out of memory */
+        array<T, Alloc> *ar = handle.mutRef();
+        return ar ? ar->data() : nullptr;
+    }
+
+    const T *data() const {
+        /*! Direct read access to the contiguous entries.
+        @return pointer to the first entry, valid until the array is modified */
+        const array<T, Alloc> *ar = handle.get();
+        return ar ? ar->data() : nullptr;
+    }
+
+    bool isEmpty() const {
+        /*! Check, if array is empty.
+        @return true if array empty, false otherwise. */
+        return length() == 0;
+    }
+
+    unsigned int length() const {
+        /*! Check number of array-members.
+        @return number of array entries */
+        const array<T, Alloc> *ar = handle.get();
+        return ar ? ar->length() : 0;
+    }
+
+    unsigned int alloclen() const {
+        /*! Check the number of allocated array-entries.
+        @return number of allocated entries. */
+        const array<T, Alloc> *ar = handle.get();
+        return ar ? ar->alloclen() : 0;
+    }
+};
+
+}  // namespace ustd
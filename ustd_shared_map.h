@@ -0,0 +1,225 @@
+// ustd_shared_map.h - copy-on-write map with O(1) copies
+
+#pragma once
+
+#include "ustd_map.h"
+#include "ustd_shared_array.h"
+
+namespace ustd {
+
+namespace details {
+
+template <class K, class V, class A> struct cowCopy<map<K, V, A>> {
+    static bool complete(const map<K, V, A> &orig, const map<K, V, A> &copy) {
+        // the map copy constructor leaves the key or value array of the copy
+        // empty, if allocation failed
+        return orig.keys.length() == copy.keys.length() &&
+               orig.values.length() == copy.values.length();
+    }
+};
+
+}  // namespace details
+
+/*! \brief Copy-on-write dictionary map with O(1) copies.
+
+ustd_shared_map.h is the map counterpart of \ref ustd::shared_array: copies of
+a shared_map share the keys and values of a \ref ustd::map and only increment a
+reference count. The keys and values are duplicated on the first modification
+of a shared copy. The reference count is atomic on platforms with
+USTD_FEATURE_ATOMIC.
+
+Reads with operator[] on a const shared_map or with find() never copy. The
+non-const operator[] is a write access (it inserts missing keys, like
+\ref ustd::map) and creates a private copy, if the map is shared.
+The returned reference stays valid until the next modification, copies made
+meanwhile get their own keys and values. Use set() for writes that keep later
+copies O(1). A moved-from shared_map is empty and
+can be reused.
+
+Make sure to provide the <a
+href="https://github.com/muwerk/ustd/blob/master/README.md">required platform
+define</a> before including ustd headers.
+
+## An example:
+
+~~~{.cpp}
+#define __UNIXOID__ 1   // Platform defines required, see doc, mainpage.
+#include <ustd_shared_map.h>
+
+void onConfig(const ustd::shared_map<int, double> &config) {
+    double gain = config[3];  // const read, no copy
+}
+
+ustd::shared_map<int, double> config;
+config.set(3, 1.5);
+ustd::shared_map<int, double> snapshot = config;  // O(1)
+config.set(3, 2.0);                               // config detaches, snapshot[3] is still 1.5
+for (auto key : snapshot.keysArray()) {
+    printf("%d->%f\n", key, snapshot.get(key));
+}
+~~~
+ */
+template <class K, class V, class Alloc = mallocAllocator> class shared_map {
+  private:
+    details::cowHandle<map<K, V, Alloc>, Alloc> handle;
+    V bad = {};
+
+  public:
+    shared_map(unsigned int startSize = ARRAY_INIT_SIZE, unsigned int maxSize = ARRAY_MAX_SIZE,
+               unsigned int incSize = ARRAY_INC_SIZE, bool shrink = true,
+               arrayGrowth growth = arrayGrowth(), const Alloc &alloc = Alloc())
+        : handle(alloc, startSize, maxSize, incSize, shrink, growth, alloc) {
+        /*!
+         * Constructs an empty shared_map, see \ref ustd::map::map() for the
+         * allocation hints.
+         * @param startSize The number of map entries that are allocated
+         * during object creation
+         * @param maxSize The maximal limit of records that will be allocated.
+         * @param incSize The number of map entries that are allocated as a
+         * chunk if the map needs to grow
+         * @param shrink Boolean indicating, if the map should deallocate
+         * memory, if the map size shrinks (due to erase()).
+         * @param growth Growth policy of the key and value arrays, see
+         * \ref ustd::arrayGrowth.
+         * @param alloc Allocator for the keys, values and the reference
+         * count, see \ref ustd::mallocAllocator.
+         */
+    }
+
+    bool detach() {
+        /*! Make sure that the keys and values are not shared with other copies.
+        This is done automatically by all modifications.
+        @return true on success, false if the copy could not be allocated */
+        return handle.detach();
+    }
+
+    unsigned int useCount() const {
+        /*! Number of copies that share the keys and values
+        @return reference count, 0 if there is no map (out of memory or
+        moved-from) */
+        return handle.useCount();
+    }
+
+    bool isShared() const {
+        /*! Check, if the map is shared with another copy, in which case the next
+        modification copies it */
+        return handle.useCount() > 1;
+    }
+
+    V get(K key) const {
+        /*! Read value of map for given key without copying the map, same as
+        the const operator[].
+        @param key map-key
+        @return Corresponding value, or the value set by setInvalidValue() if
+        key is not in the map */
+        const map<K, V, Alloc> *mp = handle.get();
+        if (mp == nullptr)
+            return bad;
+        int i = mp->find(key);
+        if (i == -1)
+            return bad;
+        return mp->values.data()[i];
+    }
+
+    V operator[](K key) const {
+        /*! Read value of map for given key, a=myMap[3].
+        @param key map-key
+        @return Corresponding value, or the value set by setInvalidValue() if
+        key is not in the map */
+        return get(key);
+    }
+
+    V &operator[](K key) {
+        /*! Write a map value for a given key, detaches the map, if it is shared
+        @param key map-key
+        @return value on success, or setInvalidValue() on error (e.g. map full)
+      */
+        map<K, V, Alloc> *mp = handle.mutRef();
+        if (mp == nullptr)
+            return bad;
+        return (*mp)[key];
+    }
+
+    bool set(K key, const V &value) {
+        /*! Write a map value for a given key like the non-const operator[],
+        but without handing out a reference, so later copies still share the
+        map.
+        @param key map-key
+        @param value new value
+        @return true on success, false on error (e.g. map full) */
+        map<K, V, Alloc> *mp = handle.mut();
+        if (mp == nullptr)
+            return false;
+        (*mp)[key];  // inserts missing keys
+        int i = mp->find(key);
+        if (i == -1)
+            return false;
+        mp->values[i] = value;
+        return true;
+    }
+
+    int find(K key) const {
+        /*! Get the index of the key and value arrays of the map
+        @param key Map-key.
+        @return index, if found, -1 on error */
+        const map<K, V, Alloc> *mp = handle.get();
+        return mp ? mp->find(key) : -1;
+    }
+
+    int erase(K key) {
+        /*! Delete the entry corresponding to map-key, detaches the map, if it is
+        shared and contains key.
+        @param key Map-key of entry to be deleted
+        @return index of entry been deleted or -1 on error */
+        if (find(key) == -1)
+            return -1;
+        map<K, V, Alloc> *mp = handle.mut();
+        return mp ? mp->erase(key) : -1;
+    }
+
+    int eraseUnordered(K key) {
+        /*! Delete the entry corresponding to map-key in O(1) after the lookup,
+        see \ref ustd::map::eraseUnordered().
+        @param key Map-key of entry to be deleted
+        @return index of entry been deleted or -1 on error */
+        if (find(key) == -1)
+            return -1;
+        map<K, V, Alloc> *mp = handle.mut();
+        return mp ? mp->eraseUnordered(key) : -1;
+    }
+
+    void setInvalidValue(V &entryInvalidValue) {
+        /*! Set the value that's given back, if read of an invalid key is
+        requested, see \ref ustd::map::setInvalidValue() */
+        bad = entryInvalidValue;
+    }
+
+    bool isEmpty() const {
+        /*! Check, if map is empty.
+        @return boolean true on empty map */
+        return length() == 0;
+    }
+
+    span<const K> keysArray() const {
+        /*! View of the keys, e.g. for iteration, without copying the map
+        @return view of the keys, valid until the map is modified */
+        const map<K, V, Alloc> *mp = handle.get();
+        return mp ? span<const K>(mp->keys) : span<const K>();
+    }
+
+    span<const V> valuesArray() const {
+        /*! View of the values, in the order of keysArray()
+        @return view of the values, valid until the map is modified */
+        const map<K, V, Alloc> *mp = handle.get();
+        return mp ? span<const V>(mp->values) : span<const V>();
+    }
+
+    unsigned int length() const {
+        /*! Check number of map-members.
+        @return number of map entries */
+        const map<K, V, Alloc> *mp = handle.get();
+        return mp ? mp->keys.length() : 0;
+    }
+};
+
+}  // namespace ustd
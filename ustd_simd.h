@@ -0,0 +1,812 @@
+// ustd_simd.h - vectorized search and reduction for arithmetic arrays
+
+#pragma once
+
+#include "ustd_array.h"
+#include "ustd_span.h"
+
+/*! \file ustd_simd.h
+Vectorized indexOf(), contains(), count(), minValue(), maxValue() and sum() for
+\ref ustd::array and raw ranges.
+
+On Unixoids the kernels for int, unsigned int and float use SIMD instructions,
+selected at compile time from the compiler's target flags. indexOf(), contains()
+and count() are vectorized for all integral types of 8, 16, 32 and 64 bits
+(char, short, long, long long, signed and unsigned) as well:
+
+* * AVX2 (x86, e.g. -mavx2 or -march=native): 8 entries per step, USTD_SIMD_AVX2
+* * SSE2 (all x86_64): 4 entries per step, USTD_SIMD_SSE2
+* * NEON (ARM, e.g. Raspberry Pi, Apple silicon): 4 entries per step, USTD_SIMD_NEON
+
+All other platforms and element types use plain scalar loops with the same
+results, so code using these functions is portable. Define USTD_NO_SIMD before
+including ustd headers to force the scalar versions.
+
+minValue() and maxValue() are used instead of min() and max(), since the
+latter are macros on Arduino cores. For float ranges the vector versions may
+round sum() differently than a sequential loop, and ranges containing NaN give
+unspecified results for minValue() and maxValue(). Integer sums wrap around on
+overflow.
+
+\ref ustd::map uses indexOf() for its key lookups.
+
+Make sure to provide the <a
+href="https://github.com/muwerk/ustd/blob/master/README.md">required platform
+define</a> before including ustd headers.
+
+## An example:
+
+~~~{.cpp}
+#define __UNIXOID__ 1   // Platform defines required, see doc, mainpage.
+#include <ustd_simd.h>
+
+ustd::array<int> ids;
+...
+int i = ustd::indexOf(ids, 4711);  // -1, if not found
+unsigned int n = ustd::count(ids, 0);
+int lo = ustd::minValue(ids);
+~~~
+*/
+
+#if defined(__UNIXOID__) && !defined(USTD_NO_SIMD)
+#if defined(__AVX2__)
+#define USTD_SIMD_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#define USTD_SIMD_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define USTD_SIMD_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+namespace ustd {
+namespace details {
+
+// Vector traits: reg, lanes, load(), set1(), eqMask() (one bit per equal lane),
+// add(), min(), max() and store(). Only defined for the selected instruction set.
+template <typename T> struct simdVec {
+    static const bool enabled = false;
+};
+
+#if defined(USTD_SIMD_AVX2)
+template <> struct simdVec<int> {
+    static const bool enabled = true;
+    typedef __m256i reg;
+    static const unsigned int lanes = 8;
+    static reg load(const int *p) {
+        return _mm256_loadu_si256((const __m256i *)p);
+    }
+    static reg set1(int v) {
+        return _mm256_set1_epi32(v);
+    }
+    static unsigned int eqMask(reg a, reg b) {
+        return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)));
+    }
+    static reg add(reg a, reg b) {
+        return _mm256_add_epi32(a, b);
+    }
+    static reg min(reg a, reg b) {
+        return _mm256_min_epi32(a, b);
+    }
+    static reg max(reg a, reg b) {
+        return _mm256_max_epi32(a, b);
+    }
+    static void store(int *p, reg a) {
+        _mm256_storeu_si256((__m256i *)p, a);
+    }
+};
+template <> struct simdVec<unsigned int> {
+    static const bool enabled = true;
+    typedef __m256i reg;
+    static const unsigned int lanes = 8;
+    static reg load(const unsigned int *p) {
+        return _mm256_loadu_si256((const __m256i *)p);
+    }
+    static reg set1(unsigned int v) {
+        return _mm256_set1_epi32((int)v);
+    }
+    static unsigned int eqMask(reg a, reg b) {
+        return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)));
+    }
+    static reg add(reg a, reg b) {
+        return _mm256_add_epi32(a, b);
+    }
+    static reg min(reg a, reg b) {
+        return _mm256_min_epu32(a, b);
+    }
+    static reg max(reg a, reg b) {
+        return _mm256_max_epu32(a, b);
+    }
+    static void store(unsigned int *p, reg a) {
+        _mm256_storeu_si256((__m256i *)p, a);
+    }
+};
+template <> struct simdVec<float> {
+    static const bool enabled = true;
+    typedef __m256 reg;
+    static const unsigned int lanes = 8;
+    static const unsigned int laneBits = 1;
+    static reg load(const float *p) {
+        return _mm256_loadu_ps(p);
+    }
+    static reg set1(float v) {
+        return _mm256_set1_ps(v);
+    }
+    static unsigned int eqMask(reg a, reg b) {
+        return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ));
+    }
+    static reg add(reg a, reg b) {
+        return _mm256_add_ps(a, b);
+    }
+    static reg min(reg a, reg b) {
+        return _mm256_min_ps(a, b);
+    }
+    static reg max(reg a, reg b) {
+        return _mm256_max_ps(a, b);
+    }
+    static void store(float *p, reg a) {
+        _mm256_storeu_ps(p, a);
+    }
+};
+#elif defined(USTD_SIMD_SSE2)
+// SSE2 has no 32 bit integer min/max: select with a compare mask
+inline __m128i sse2Select(__m128i mask, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+template <> struct simdVec<int> {
+    static const bool enabled = true;
+    typedef __m128i reg;
+    static const unsigned int lanes = 4;
+    static reg load(const int *p) {
+        return _mm_loadu_si128((const __m128i *)p);
+    }
+    static reg set1(int v) {
+        return _mm_set1_epi32(v);
+    }
+    static unsigned int eqMask(reg a, reg b) {
+        return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b)));
+    }
+    static reg add(reg a, reg b) {
+        return _mm_add_epi32(a, b);
+    }
+    static reg min(reg a, reg b) {
+        return sse2Select(_mm_cmplt_epi32(a, b), a, b);
+    }
+    static reg max(reg a, reg b) {
+        return sse2Select(_mm_cmpgt_epi32(a, b), a, b);
+    }
+    static void store(int *p, reg a) {
+        _mm_storeu_si128((__m128i *)p, a);
+    }
+};
+template <> struct simdVec<unsigned int> {
+    static const bool enabled = true;
+    typedef __m128i reg;
+    static const unsigned int lanes = 4;
+    static reg load(const unsigned int *p) {
+        return _mm_loadu_si128((const __m128i *)p);
+    }
+    static reg set1(unsigned int v) {
+        return _mm_set1_epi32((int)v);
+    }
+    static unsigned int eqMask(reg a, reg b) {
+        return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b)));
+    }
+    static reg add(reg a, reg b) {
+        return _mm_add_epi32(a, b);
+    }
+    static reg min(reg a, reg b) {
+        // unsigned compare: flip the sign bits and compare signed
+        const reg bias = _mm_set1_epi32((int)0x80000000);
+        return sse2Select(_mm_cmplt_epi32(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias)), a, b);
+    }
+    static reg max(reg a, reg b) {
+        const reg bias = _mm_set1_epi32((int)0x80000000);
+        return sse2Select(_mm_cmpgt_epi32(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias)), a, b);
+    }
+    static void store(unsigned int *p, reg a) {
+        _mm_storeu_si128((__m128i *)p, a);
+    }
+};
+template <> struct simdVec<float> {
+    static const bool enabled = true;
+    typedef __m128 reg;
+    static const unsigned int lanes = 4;
+    static const unsigned int laneBits = 1;
+    static reg load(const float *p) {
+        return _mm_loadu_ps(p);
+    }
+    static reg set1(float v) {
+        return _mm_set1_ps(v);
+    }
+    static unsigned int eqMask(reg a, reg b) {
+        return _mm_movemask_ps(_mm_cmpeq_ps(a, b));
+    }
+    static reg add(reg a, reg b) {
+        return _mm_add_ps(a, b);
+    }
+    static reg min(reg a, reg b) {
+        return _mm_min_ps(a, b);
+    }
+    static reg max(reg a, reg b) {
+        return _mm_max_ps(a, b);
+    }
+    static void store(float *p, reg a) {
+        _mm_storeu_ps(p, a);
+    }
+};
+#elif defined(USTD_SIMD_NEON)
+inline unsigned int neonMask(uint32x4_t eq) {
+    // one bit per lane from an all-ones/all-zeros compare result
+    const uint32_t bits[4] = {1, 2, 4, 8};
+    uint32x4_t m = vandq_u32(eq, vld1q_u32(bits));
+    uint32x2_t s = vadd_u32(vget_low_u32(m), vget_high_u32(m));
+    return vget_lane_u32(vpadd_u32(s, s), 0);
+}
+template <> struct simdVec<int> {
+    static const bool enabled = true;
+    typedef int32x4_t reg;
+    static const unsigned int lanes = 4;
+    static reg load(const int *p) {
+        return vld1q_s32((const int32_t *)p);
+    }
+    static reg set1(int v) {
+        return vdupq_n_s32(v);
+    }
+    static unsigned int eqMask(reg a, reg b) {
+        return neonMask(vceqq_s32(a, b));
+    }
+    static reg add(reg a, reg b) {
+        return vaddq_s32(a, b);
+    }
+    static reg min(reg a, reg b) {
+        return vminq_s32(a, b);
+    }
+    static reg max(reg a, reg b) {
+        return vmaxq_s32(a, b);
+    }
+    static void store(int *p, reg a) {
+        vst1q_s32((int32_t *)p, a);
+    }
+};
+template <> struct simdVec<unsigned int> {
+    static const bool enabled = true;
+    typedef uint32x4_t reg;
+    static const unsigned int lanes = 4;
+    static reg load(const unsigned int *p) {
+        return vld1q_u32((const uint32_t *)p);
+    }
+    static reg set1(unsigned int v) {
+        return vdupq_n_u32(v);
+    }
+    static unsigned int eqMask(reg a, reg b) {
+        return neonMask(vceqq_u32(a, b));
+    }
+    static reg add(reg a, reg b) {
+        return vaddq_u32(a, b);
+    }
+    static reg min(reg a, reg b) {
+        return vminq_u32(a, b);
+    }
+    static reg max(reg a, reg b) {
+        return vmaxq_u32(a, b);
+    }
+    static void store(unsigned int *p, reg a) {
+        vst1q_u32((uint32_t *)p, a);
+    }
+};
+template <> struct simdVec<float> {
+    static const bool enabled = true;
+    typedef float32x4_t reg;
+    static const unsigned int lanes = 4;
+    static const unsigned int laneBits = 1;
+    static reg load(const float *p) {
+        return vld1q_f32(p);
+    }
+    static reg set1(float v) {
+        return vdupq_n_f32(v);
+    }
+    static unsigned int eqMask(reg a, reg b) {
+        return neonMask(vceqq_f32(a, b));
+    }
+    static reg add(reg a, reg b) {
+        return vaddq_f32(a, b);
+    }
+    static reg min(reg a, reg b) {
+        return vminq_f32(a, b);
+    }
+    static reg max(reg a, reg b) {
+        return vmaxq_f32(a, b);
+    }
+    static void store(float *p, reg a) {
+        vst1q_f32(p, a);
+    }
+};
+#endif
+
+template <typename T> struct isIntegral {
+    static const bool value = false;
+};
+template <> struct isIntegral<char> {
+    static const bool value = true;
+};
+template <> struct isIntegral<signed char> {
+    static const bool value = true;
+};
+template <> struct isIntegral<unsigned char> {
+    static const bool value = true;
+};
+template <> struct isIntegral<short> {
+    static const bool value = true;
+};
+template <> struct isIntegral<unsigned short> {
+    static const bool value = true;
+};
+template <> struct isIntegral<int> {
+    static const bool value = true;
+};
+template <> struct isIntegral<unsigned int> {
+    static const bool value = true;
+};
+template <> struct isIntegral<long> {
+    static const bool value = true;
+};
+template <> struct isIntegral<unsigned long> {
+    static const bool value = true;
+};
+template <> struct isIntegral<long long> {
+    static const bool value = true;
+};
+template <> struct isIntegral<unsigned long long> {
+    static const bool value = true;
+};
+
+// Equality traits for integral types by size S, signed and unsigned types share
+// the kernels: reg, lanes, load(), set1() and eqMask() with laneBits bits per
+// equal lane. Used by indexOf(), contains() and count().
+template <typename T, unsigned int S = sizeof(T)> struct simdEqVec {
+    static const bool enabled = false;
+};
+
+#if defined(USTD_SIMD_AVX2)
+template <typename T> struct simdEqVec<T, 1> {
+    static const bool enabled = true;
+    typedef __m256i reg;
+    static const unsigned int lanes = 32;
+    static const unsigned int laneBits = 1;
+    static reg load(const T *p) {
+        return _mm256_loadu_si256((const __m256i *)p);
+    }
+    static reg set1(T v) {
+        return _mm256_set1_epi8((char)v);
+    }
+    static unsigned int eqMask(reg a, reg b) {
+        return (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b));
+    }
+};
+template <typename T> struct simdEqVec<T, 2> {
+    static const bool enabled = true;
+    typedef __m256i reg;
+    static const unsigned int lanes = 16;
+    static const unsigned int laneBits = 2;
+    static reg load(const T *p) {
+        return _mm256_loadu_si256((const __m256i *)p);
+    }
+    static reg set1(T v) {
+        return _mm256_set1_epi16((short)v);
+    }
+    static unsigned int eqMask(reg a, reg b) {
+        return (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi16(a, b));
+    }
+};
+template <typename T> struct simdEqVec<T, 4> {
+    static const bool enabled = true;
+    typedef __m256i reg;
+    static const unsigned int lanes = 8;
+    static const unsigned int laneBits = 1;
+    static reg load(const T *p) {
+        return _mm256_loadu_si256((const __m256i *)p);
+    }
+    static reg set1(T v) {
+        return _mm256_set1_epi32((int)v);
+    }
+    static unsigned int eqMask(reg a, reg b) {
+        return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)));
+    }
+};
+template <typename T> struct simdEqVec<T, 8> {
+    static const bool enabled = true;
+    typedef __m256i reg;
+    static const unsigned int lanes = 4;
+    static const unsigned int laneBits = 1;
+    static reg load(const T *p) {
+        return _mm256_loadu_si256((const __m256i *)p);
+    }
+    static reg set1(T v) {
+        return _mm256_set1_epi64x((long long)v);
+    }
+    static unsigned int eqMask(reg a, reg b) {
+        return _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(a, b)));
+    }
+};
+#elif defined(USTD_SIMD_SSE2)
+template <typename T> struct simdEqVec<T, 1> {
+    static const bool enabled = true;
+    typedef __m128i reg;
+    static const unsigned int lanes = 16;
+    static const unsigned int laneBits = 1;
+    static reg load(const T *p) {
+        return _mm_loadu_si128((const __m128i *)p);
+    }
+    static reg set1(T v) {
+        return _mm_set1_epi8((char)v);
+    }
+    static unsigned int eqMask(reg a, reg b) {
+        return (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(a, b));
+    }
+};
+template <typename T> struct simdEqVec<T, 2> {
+    static const bool enabled = true;
+    typedef __m128i reg;
+    static const unsigned int lanes = 8;
+    static const unsigned int laneBits = 2;
+    static reg load(const T *p) {
+        return _mm_loadu_si128((const __m128i *)p);
+    }
+    static reg set1(T v) {
+        return _mm_set1_epi16((short)v);
+    }
+    static unsigned int eqMask(reg a, reg b) {
+        return (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi16(a, b));
+    }
+};
+template <typename T> struct simdEqVec<T, 4> {
+    static const bool enabled = true;
+    typedef __m128i reg;
+    static const unsigned int lanes = 4;
+    static const unsigned int laneBits = 1;
+    static reg load(const T *p) {
+        return _mm_loadu_si128((const __m128i *)p);
+    }
+    static reg set1(T v) {
+        return _mm_set1_epi32((int)v);
+    }
+    static unsigned int eqMask(reg a, reg b) {
+        return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b)));
+    }
+};
+template <typename T> struct simdEqVec<T, 8> {
+    static const bool enabled = true;
+    typedef __m128i reg;
+    static const unsigned int lanes = 2;
+    static const unsigned int laneBits = 1;
+    static reg load(const T *p) {
+        return _mm_loadu_si128((const __m128i *)p);
+    }
+    static reg set1(T v) {
+        return _mm_set1_epi64x((long long)v);
+    }
+    static unsigned int eqMask(reg a, reg b) {
+        // SSE2 has no 64 bit compare: both 32 bit halves must be equal
+        __m128i eq = _mm_cmpeq_epi32(a, b);
+        eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_movemask_pd(_mm_castsi128_pd(eq));
+    }
+};
+#elif defined(USTD_SIMD_NEON)
+// NEON has no movemask: narrow the compare result, 4 bits per byte lane
+inline unsigned long long neonNarrowMask(uint16x8_t eq) {
+    return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(eq, 4)), 0);
+}
+template <typename T> struct simdEqVec<T, 1> {
+    static const bool enabled = true;
+    typedef uint8x16_t reg;
+    static const unsigned int lanes = 16;
+    static const unsigned int laneBits = 4;
+    static reg load(const T *p) {
+        return vld1q_u8((const uint8_t *)p);
+    }
+    static reg set1(T v) {
+        return vdupq_n_u8((uint8_t)v);
+    }
+    static unsigned long long eqMask(reg a, reg b) {
+        return neonNarrowMask(vreinterpretq_u16_u8(vceqq_u8(a, b)));
+    }
+};
+template <typename T> struct simdEqVec<T, 2> {
+    static const bool enabled = true;
+    typedef uint16x8_t reg;
+    static const unsigned int lanes = 8;
+    static const unsigned int laneBits = 8;
+    static reg load(const T *p) {
+        return vld1q_u16((const uint16_t *)p);
+    }
+    static reg set1(T v) {
+        return vdupq_n_u16((uint16_t)v);
+    }
+    static unsigned long long eqMask(reg a, reg b) {
+        return neonNarrowMask(vceqq_u16(a, b));
+    }
+};
+template <typename T> struct simdEqVec<T, 4> {
+    static const bool enabled = true;
+    typedef uint32x4_t reg;
+    static const unsigned int lanes = 4;
+    static const unsigned int laneBits = 1;
+    static reg load(const T *p) {
+        return vld1q_u32((const uint32_t *)p);
+    }
+    static reg set1(T v) {
+        return vdupq_n_u32((uint32_t)v);
+    }
+    static unsigned int eqMask(reg a, reg b) {
+        return neonMask(vceqq_u32(a, b));
+    }
+};
+template <typename T> struct simdEqVec<T, 8> {
+    static const bool enabled = true;
+    typedef uint32x4_t reg;  // 32 bit compares, vceqq_u64 is AArch64 only
+    static const unsigned int lanes = 2;
+    static const unsigned int laneBits = 32;
+    static reg load(const T *p) {
+        return vld1q_u32((const uint32_t *)p);
+    }
+    static reg set1(T v) {
+        return vreinterpretq_u32_u64(vdupq_n_u64((uint64_t)v));
+    }
+    static unsigned long long eqMask(reg a, reg b) {
+        // both 32 bit halves must be equal
+        uint32x4_t eq = vceqq_u32(a, b);
+        eq = vandq_u32(eq, vrev64q_u32(eq));
+        return neonNarrowMask(vreinterpretq_u16_u32(eq));
+    }
+};
+#endif
+
+// traits for the equality search of T
+template <typename T, bool I = isIntegral<T>::value> struct simdEq {
+    typedef simdVec<T> vec;
+};
+template <typename T> struct simdEq<T, true> {
+    typedef simdEqVec<T> vec;
+};
+
+typedef boolTag<true> simdTag;
+typedef boolTag<false> scalarTag;
+
+template <typename T> struct isSimd {
+    typedef boolTag<simdVec<T>::enabled> tag;
+};
+
+template <typename T> struct isSimdEq {
+    typedef boolTag<simdEq<T>::vec::enabled> tag;
+};
+
+// scalar kernels, used for all types without vector traits and for the tails
+
+template <typename T> const T *scalarFind(const T *first, const T *last, const T &value) {
+    for (; first != last; ++first) {
+        if (*first == value)
+            return first;
+    }
+    return last;
+}
+
+template <typename T> unsigned int scalarCount(const T *first, const T *last, const T &value) {
+    unsigned int n = 0;
+    for (; first != last; ++first) {
+        if (*first == value)
+            ++n;
+    }
+    return n;
+}
+
+template <typename T> T scalarMin(const T *first, const T *last, T m) {
+    for (; first != last; ++first) {
+        if (*first < m)
+            m = *first;
+    }
+    return m;
+}
+
+template <typename T> T scalarMax(const T *first, const T *last, T m) {
+    for (; first != last; ++first) {
+        if (m < *first)
+            m = *first;
+    }
+    return m;
+}
+
+template <typename T> T scalarSum(const T *first, const T *last, T s) {
+    for (; first != last; ++first)
+        s += *first;
+    return s;
+}
+
+template <typename T>
+const T *simdFind(const T *first, const T *last, const T &value, scalarTag) {
+    return scalarFind(first, last, value);
+}
+template <typename T>
+const T *simdFind(const T *first, const T *last, const T &value, simdTag) {
+    typedef typename simdEq<T>::vec V;
+    typename V::reg needle = V::set1(value);
+    for (; last - first >= (long)V::lanes; first += V::lanes) {
+        unsigned long long mask = V::eqMask(V::load(first), needle);
+        if (mask)
+            return first + __builtin_ctzll(mask) / V::laneBits;
+    }
+    return scalarFind(first, last, value);
+}
+
+template <typename T>
+unsigned int simdCount(const T *first, const T *last, const T &value, scalarTag) {
+    return scalarCount(first, last, value);
+}
+template <typename T>
+unsigned int simdCount(const T *first, const T *last, const T &value, simdTag) {
+    typedef typename simdEq<T>::vec V;
+    typename V::reg needle = V::set1(value);
+    unsigned int n = 0;
+    for (; last - first >= (long)V::lanes; first += V::lanes)
+        n += __builtin_popcountll(V::eqMask(V::load(first), needle)) / V::laneBits;
+    return n + scalarCount(first, last, value);
+}
+
+template <typename T> T simdMin(const T *first, const T *last, scalarTag) {
+    return scalarMin(first + 1, last, *first);
+}
+template <typename T> T simdMin(const T *first, const T *last, simdTag) {
+    typedef simdVec<T> V;
+    if (last - first < (long)V::lanes)
+        return scalarMin(first + 1, last, *first);
+    typename V::reg m = V::load(first);
+    for (first += V::lanes; last - first >= (long)V::lanes; first += V::lanes)
+        m = V::min(m, V::load(first));
+    T lanes[V::lanes];
+    V::store(lanes, m);
+    return scalarMin(first, last, scalarMin(lanes + 1, lanes + V::lanes, lanes[0]));
+}
+
+template <typename T> T simdMax(const T *first, const T *last, scalarTag) {
+    return scalarMax(first + 1, last, *first);
+}
+template <typename T> T simdMax(const T *first, const T *last, simdTag) {
+    typedef simdVec<T> V;
+    if (last - first < (long)V::lanes)
+        return scalarMax(first + 1, last, *first);
+    typename V::reg m = V::load(first);
+    for (first += V::lanes; last - first >= (long)V::lanes; first += V::lanes)
+        m = V::max(m, V::load(first));
+    T lanes[V::lanes];
+    V::store(lanes, m);
+    return scalarMax(first, last, scalarMax(lanes + 1, lanes + V::lanes, lanes[0]));
+}
+
+template <typename T> T simdSum(const T *first, const T *last, scalarTag) {
+    return scalarSum(first, last, T());
+}
+template <typename T> T simdSum(const T *first, const T *last, simdTag) {
+    typedef simdVec<T> V;
+    if (last - first < (long)V::lanes)
+        return scalarSum(first, last, T());
+    typename V::reg s = V::load(first);
+    for (first += V::lanes; last - first >= (long)V::lanes; first += V::lanes)
+        s = V::add(s, V::load(first));
+    T lanes[V::lanes];
+    V::store(lanes, s);
+    return scalarSum(first, last, scalarSum(lanes, lanes + V::lanes, T()));
+}
+
+}  // namespace details
+
+template <typename T> int indexOf(const T *first, const T *last, const T &value) {
+    /*! Find the first entry equal to value in [first, last)
+    @return index of the entry relative to first, or -1 if not found */
+    const T *p = details::simdFind(first, last, value, typename details::isSimdEq<T>::tag());
+    return p == last ? -1 : (int)(p - first);
+}
+
+template <typename T> bool contains(const T *first, const T *last, const T &value) {
+    /*! Check, if [first, last) contains value
+    @return true, if an entry equal to value exists */
+    return indexOf(first, last, value) != -1;
+}
+
+template <typename T> unsigned int count(const T *first, const T *last, const T &value) {
+    /*! Count the entries in [first, last) that are equal to value
+    @return number of matching entries */
+    return details::simdCount(first, last, value, typename details::isSimdEq<T>::tag());
+}
+
+template <typename T> T minValue(const T *first, const T *last) {
+    /*! Smallest entry of [first, last)
+    @return smallest entry, or T() for an empty range */
+    if (first == last)
+        return T();
+    return details::simdMin(first, last, typename details::isSimd<T>::tag());
+}
+
+template <typename T> T maxValue(const T *first, const T *last) {
+    /*! Largest entry of [first, last)
+    @return largest entry, or T() for an empty range */
+    if (first == last)
+        return T();
+    return details::simdMax(first, last, typename details::isSimd<T>::tag());
+}
+
+template <typename T> T sum(const T *first, const T *last) {
+    /*! Sum of all entries of [first, last)
+    @return sum, T() for an empty range */
+    return details::simdSum(first, last, typename details::isSimd<T>::tag());
+}
+
+// ---- ustd::array -----------------------------------------------------------
+
+template <typename T, typename A> int indexOf(const array<T, A> &ar, const T &value) {
+    /*! Index of the first entry of ar equal to value
+    @return index, or -1 if not found */
+    return indexOf(ar.data(), ar.data() + ar.length(), value);
+}
+
+template <typename T, typename A> bool contains(const array<T, A> &ar, const T &value) {
+    /*! Check, if array ar contains value */
+    return indexOf(ar.data(), ar.data() + ar.length(), value) != -1;
+}
+
+template <typename T, typename A> unsigned int count(const array<T, A> &ar, const T &value) {
+    /*! Number of entries of ar equal to value */
+    return count(ar.data(), ar.data() + ar.length(), value);
+}
+
+template <typename T, typename A> T minValue(const array<T, A> &ar) {
+    /*! Smallest entry of ar, T() if ar is empty */
+    return minValue(ar.data(), ar.data() + ar.length());
+}
+
+template <typename T, typename A> T maxValue(const array<T, A> &ar) {
+    /*! Largest entry of ar, T() if ar is empty */
+    return maxValue(ar.data(), ar.data() + ar.length());
+}
+
+template <typename T, typename A> T sum(const array<T, A> &ar) {
+    /*! Sum of all entries of ar */
+    return sum(ar.data(), ar.data() + ar.length());
+}
+
+// ---- ustd::span ------------------------------------------------------------
+
+template <typename T, typename V> int indexOf(span<T> s, const V &value) {
+    /*! Index of the first entry of view s equal to value
+    @return index, or -1 if not found */
+    return indexOf<typename details::removeConst<T>::type>(s.begin(), s.end(), value);
+}
+
+template <typename T, typename V> bool contains(span<T> s, const V &value) {
+    /*! Check, if view s contains value */
+    return indexOf(s, value) != -1;
+}
+
+template <typename T, typename V> unsigned int count(span<T> s, const V &value) {
+    /*! Number of entries of view s equal to value */
+    return count<typename details::removeConst<T>::type>(s.begin(), s.end(), value);
+}
+
+template <typename T> typename details::removeConst<T>::type minValue(span<T> s) {
+    /*! Smallest entry of view s, T() if s is empty */
+    return minValue<typename details::removeConst<T>::type>(s.begin(), s.end());
+}
+
+template <typename T> typename details::removeConst<T>::type maxValue(span<T> s) {
+    /*! Largest entry of view s, T() if s is empty */
+    return maxValue<typename details::removeConst<T>::type>(s.begin(), s.end());
+}
+
+template <typename T> typename details::removeConst<T>::type sum(span<T> s) {
+    /*! Sum of all entries of view s */
+    return sum<typename details::removeConst<T>::type>(s.begin(), s.end());
+}
+
+}  // namespace ustd
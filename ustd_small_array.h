@@ -0,0 +1,398 @@
+// ustd_small_array.h - array with inline storage for small sizes
+
+#pragma once
+
+#include "ustd_array.h"
+
+namespace ustd {
+
+/*! \brief Lightweight c++11 array with inline storage for the first N entries.
+
+ustd_small_array.h provides an array with the same interface as \ref ustd::array,
+but the first N entries are stored inside the object itself. Memory is only
+allocated on the heap, if the array grows beyond N entries. If shrink is true
+and the array shrinks back to N/2 entries or less, the heap memory is freed and
+the entries move back into the inline storage. The heap memory comes from the
+optional allocator, see \ref ustd::mallocAllocator.
+
+Since most arrays hold only a few entries, this avoids allocations and heap
+fragmentation for short-lived arrays, e.g. in per-message code paths.
+
+Make sure to provide the <a
+href="https://github.com/muwerk/ustd/blob/master/README.md">required platform
+define</a> before including ustd headers.
+
+## An example:
+
+~~~{.cpp}
+#define __ESP__ 1   // Platform defines required, see doc, mainpage.
+#include <ustd_small_array.h>
+
+ustd::small_array<int, 8> topics;  // no heap allocation
+
+topics.add(3);  // stored inline
+for (auto t : topics) {
+    printf("%d\n", t);
+}
+~~~
+ */
+template <typename T, unsigned int N, class Alloc = mallocAllocator> class small_array {
+    static_assert(N > 0, "small_array needs an inline capacity > 0");
+
+  private:
+    T *arr;
+    unsigned int maxSize;
+    unsigned int incSize;
+    bool shrink;
+    arrayGrowth growth;
+    unsigned int allocSize;
+    unsigned int size;
+    T bad = {};
+    Alloc alloc;
+    alignas(T) unsigned char inlineBuf[N * sizeof(T)];
+
+    T *inlineArr() {
+        return reinterpret_cast<T *>(inlineBuf);
+    }
+
+    T *ualloc(unsigned int n) {
+        return (T *)alloc.allocate(n * sizeof(T));
+    }
+    void ufree(T *p, unsigned int n) {
+        alloc.deallocate(p, n * sizeof(T));
+    }
+
+    void release() {
+        details::destroyRange(arr, size);
+        if (!isInline())
+            ufree(arr, allocSize);
+        arr = inlineArr();
+        allocSize = N;
+        size = 0;
+    }
+
+    void takeOver(small_array<T, N, Alloc> &ar) {
+        alloc = ar.alloc;
+        maxSize = ar.maxSize;
+        incSize = ar.incSize;
+        shrink = ar.shrink;
+        growth = ar.growth;
+        bad = static_cast<T &&>(ar.bad);
+        size = ar.size;
+        if (ar.isInline()) {
+            arr = inlineArr();
+            allocSize = N;
+            details::relocateRange(arr, ar.arr, size);
+        } else {
+            arr = ar.arr;
+            allocSize = ar.allocSize;
+        }
+        ar.arr = ar.inlineArr();
+        ar.allocSize = N;
+        ar.size = 0;
+    }
+
+    bool reserveOne() {
+        if (size < allocSize)
+            return true;
+        if (incSize == 0)
+            return false;
+        return resize(growth.next(allocSize, incSize, maxSize));
+    }
+
+  public:
+    small_array(unsigned int maxSize = ARRAY_MAX_SIZE, unsigned int incSize = ARRAY_INC_SIZE,
+                bool shrink = true, arrayGrowth growth = arrayGrowth(),
+                const Alloc &alloc = Alloc())
+        : arr(inlineArr()), maxSize(maxSize < N ? N : maxSize), incSize(incSize),
+          shrink(shrink), growth(growth), allocSize(N), size(0), alloc(alloc) {
+        /*!
+         * Constructs a small_array object, no memory is allocated.
+         * @param maxSize The maximal limit of records that will be allocated.
+         * If maxSize > N, the array will move to the heap, if it grows beyond
+         * N entries.
+         * @param incSize The number of array entries that are allocated as a
+         * chunk if the array needs to grow
+         * @param shrink Boolean indicating, if the array should deallocate
+         * memory, if the array size shrinks (due to erase()).
+         * @param growth Growth policy, see \ref ustd::arrayGrowth.
+         * @param alloc Allocator for the heap memory, see
+         * \ref ustd::mallocAllocator.
+         */
+    }
+
+    small_array(const T initarray[], unsigned int count, const Alloc &alloc = Alloc())
+        : small_array(ARRAY_MAX_SIZE, ARRAY_INC_SIZE, true, arrayGrowth(), alloc) {
+        /*! construct small_array with const T[] c-array of length count
+        @param initarray c-array of type T
+        @param count number of entries in initarray
+        @param alloc Allocator for the heap memory */
+        if (count > N && !resize(count))
+            return;
+        details::copyRange(arr, initarray, count);
+        size = count;
+    }
+
+    small_array(const small_array<T, N, Alloc> &ar)
+        : arr(inlineArr()), maxSize(ar.maxSize), incSize(ar.incSize), shrink(ar.shrink),
+          growth(ar.growth), allocSize(N), size(0), bad(ar.bad), alloc(ar.alloc) {
+        /*! small_array copy constructor */
+        if (ar.size > N) {
+            T *p = ualloc(ar.allocSize);
+            if (p == nullptr)
+                return;
+            arr = p;
+            allocSize = ar.allocSize;
+        }
+        details::copyRange(arr, ar.arr, ar.size);
+        size = ar.size;
+    }
+
+    small_array(small_array<T, N, Alloc> &&ar) : arr(inlineArr()), alloc(ar.alloc) {
+        /*! small_array move constructor, takes over the heap memory of ar, or
+        moves the inline entries of ar. ar is left empty. */
+        takeOver(ar);
+    }
+
+    small_array<T, N, Alloc> &operator=(const small_array<T, N, Alloc> &ar) {
+        /*! small_array copy assignment */
+        if (this != &ar) {
+            small_array<T, N, Alloc> tmp(ar);
+            *this = static_cast<small_array<T, N, Alloc> &&>(tmp);
+        }
+        return *this;
+    }
+
+    small_array<T, N, Alloc> &operator=(small_array<T, N, Alloc> &&ar) {
+        /*! small_array move assignment */
+        if (this != &ar) {
+            release();
+            takeOver(ar);
+        }
+        return *this;
+    }
+
+    ~small_array() {
+        /*! Free resources */
+        release();
+    }
+
+    // iterators
+    arrayIterator<T> begin() {
+        /*! Iterator support: begin() */
+        return arrayIterator<T>(arr, 0);
+    }
+    arrayIterator<T> end() {
+        /*! Iterator support: end() */
+        return arrayIterator<T>(arr, size);
+    }
+
+    arrayIterator<const T> begin() const {
+        /*! Iterator support: begin() */
+        return arrayIterator<const T>(arr, 0);
+    }
+
+    arrayIterator<const T> end() const {
+        /*! Iterator support: end() */
+        return arrayIterator<const T>(arr, size);
+    }
+
+    bool resize(unsigned int newSize) {
+        /*! Change the array allocation size, see \ref ustd::array::resize().
+         * The allocation never shrinks below the inline capacity N.
+         * @param newSize the new number of array entries, sizes <= N move
+         * the array back into the inline storage.
+         */
+        if (newSize > maxSize) {
+            if (maxSize == allocSize)
+                return false;
+            else
+                newSize = maxSize;
+        }
+        if (newSize < N)
+            newSize = N;
+        if (newSize == allocSize || (!shrink && newSize < allocSize))
+            return true;
+        if (newSize < size) {
+            details::destroyRange(arr + newSize, size - newSize);
+            size = newSize;
+        }
+        if (isInline()) {
+            T *p = ualloc(newSize);
+            if (p == nullptr)
+                return false;
+            details::relocateRange(p, arr, size);
+            arr = p;
+        } else if (newSize == N) {
+            details::relocateRange(inlineArr(), arr, size);
+            ufree(arr, allocSize);
+            arr = inlineArr();
+        } else {
+            T *p = details::reallocRange(alloc, arr, size, allocSize, newSize);
+            if (p == nullptr)
+                return false;
+            arr = p;
+        }
+        allocSize = newSize;
+        return true;
+    }
+
+    void setInvalidValue(T &entryInvalidValue) {
+        /*! Set the value that's given back, if read of an invalid
+        index is requested, see \ref ustd::array::setInvalidValue().
+        */
+        bad = entryInvalidValue;
+    }
+
+    int add(const T &entry) {
+        /*! Append an array element after the current end of the array
+         * @param entry array element that is appended
+         * @return index of the new entry or -1 on error */
+        if (!reserveOne())
+            return -1;
+        ::new (static_cast<void *>(arr + size)) T(entry);
+        ++size;
+        return size - 1;
+    }
+
+    int add(T &&entry) {
+        /*! Append an array element by moving it after the current end of the
+         * array
+         * @param entry array element that is moved into the array
+         * @return index of the new entry or -1 on error */
+        if (!reserveOne())
+            return -1;
+        ::new (static_cast<void *>(arr + size)) T(static_cast<T &&>(entry));
+        ++size;
+        return size - 1;
+    }
+
+    template <typename... Args> int emplace(Args &&...args) {
+        /*! Construct a new array element from args after the current end of
+         * the array
+         * @param args constructor arguments for the new element
+         * @return index of the new entry or -1 on error */
+        if (!reserveOne())
+            return -1;
+        ::new (static_cast<void *>(arr + size)) T(static_cast<Args &&>(args)...);
+        ++size;
+        return size - 1;
+    }
+
+    bool erase(unsigned int index) {
+        /*! Delete array element at given index
+         * @param index The array index of the element to be erased. If the
+         * array shrinks to N/2 entries or less, heap memory is freed and the
+         * entries move back inline, if shrink=true during array creation.
+         */
+        if (index >= size) {
+            return false;
+        }
+        details::moveLeft(arr + index, arr + index + 1, size - index - 1);
+        --size;
+        details::destroyRange(arr + size, 1);
+        if (shrink && !isInline()) {
+            // back to inline storage with hysteresis at half the inline capacity
+            if (size <= N / 2)
+                return resize(N);
+            if (incSize == 0)
+                return true;
+            unsigned int target = growth.next(size, incSize, maxSize);
+            if (target < allocSize && growth.next(target, incSize, maxSize) <= allocSize) {
+                resize(target);
+            }
+        }
+        return true;
+    }
+
+    bool eraseUnordered(unsigned int index) {
+        /*! Delete array element at given index in O(1) by moving the last
+         * element into its place, see \ref ustd::array::eraseUnordered().
+         * @param index The array index of the element to be erased.
+         */
+        if (index >= size) {
+            return false;
+        }
+        if (index != size - 1)
+            arr[index] = static_cast<T &&>(arr[size - 1]);
+        return erase(size - 1);
+    }
+
+    bool erase() {
+        /*! Delete all array elements, heap memory is freed, if shrink=true
+         * during array creation.
+         */
+        details::destroyRange(arr, size);
+        size = 0;
+        if (shrink)
+            return resize(N);
+        return true;
+    }
+
+    T operator[](unsigned int i) const {
+        /*! Read content of array element at i, a=myArray[3] */
+        if (i >= size) {
+#if defined(__UNIXOID__)
+            assert(i < size);
+#endif
+            return bad;
+        }
+        return arr[i];
+    }
+
+    T &operator[](unsigned int i) {
+        /*! Assign content of array element at i, e.g. myArray[3]=3 */
+        if (i >= allocSize) {
+            if (!resize(growth.next(allocSize, incSize, maxSize))) {
+#if defined(__UNIXOID__)
+                assert(i < allocSize);
+#endif
+            }
+        }
+        if (i >= allocSize) {
+            return bad;
+        }
+        if (i >= size) {
+            details::constructRange(arr + size, i + 1 - size);
+            size = i + 1;
+        }
+        return arr[i];
+    }
+
+    T *data() {
+        /*! Direct access to the contiguous entries, e.g. for algorithms.
+        @return pointer to the first entry, valid until the array is modified */
+        return arr;
+    }
+
+    const T *data() const {
+        /*! Direct read access to the contiguous entries.
+        @return pointer to the first entry, valid until the array is modified */
+        return arr;
+    }
+
+    bool isEmpty() const {
+        /*! Check, if array is empty.
+        @return true if array empty, false otherwise. */
+        return size == 0;
+    }
+
+    bool isInline() const {
+        /*! Check, if the entries are stored inside the object.
+        @return true, if no heap memory is in use. */
+        return arr == reinterpret_cast<const T *>(inlineBuf);
+    }
+
+    unsigned int length() const {
+        /*! Check number of array-members.
+        @return number of array entries */
+        return (size);
+    }
+
+    unsigned int alloclen() const {
+        /*! Check the number of allocated array-entries, at least N.
+         * @return number of allocated entries. */
+        return (allocSize);
+    }
+};
+}  // namespace ustd
@@ -0,0 +1,314 @@
+// ustd_soa_array.h - structure-of-arrays container
+
+#pragma once
+
+#include "ustd_array.h"
+
+namespace ustd {
+
+namespace details {
+
+template <unsigned int I> struct soaIndex {};
+
+template <unsigned int I, typename... Ts> struct soaType;
+template <typename T, typename... Rest> struct soaType<0, T, Rest...> {
+    typedef T type;
+};
+template <unsigned int I, typename T, typename... Rest> struct soaType<I, T, Rest...> {
+    typedef typename soaType<I - 1, Rest...>::type type;
+};
+
+// One ustd::array per column, column I is selected by overloading on soaIndex<I>
+template <unsigned int I, typename... Ts> class soaColumns {
+  public:
+    soaColumns(unsigned int, unsigned int, unsigned int, bool, arrayGrowth) {
+    }
+    void column() {
+    }
+    int add() {
+        return 0;
+    }
+    void erase(unsigned int) {
+    }
+    void eraseUnordered(unsigned int) {
+    }
+    void eraseAll() {
+    }
+    bool reserve(unsigned int) {
+        return true;
+    }
+};
+
+template <unsigned int I, typename T, typename... Rest>
+class soaColumns<I, T, Rest...> : public soaColumns<I + 1, Rest...> {
+  private:
+    typedef soaColumns<I + 1, Rest...> base;
+    array<T> col;
+
+  public:
+    soaColumns(unsigned int startSize, unsigned int maxSize, unsigned int incSize, bool shrink,
+               arrayGrowth growth)
+        : base(startSize, maxSize, incSize, shrink, growth),
+          col(startSize, maxSize, incSize, shrink, growth) {
+    }
+    using base::column;
+    array<T> &column(soaIndex<I>) {
+        return col;
+    }
+    const array<T> &column(soaIndex<I>) const {
+        return col;
+    }
+    int add(const T &v, const Rest &...rest) {
+        int i = col.add(v);
+        if (i == -1)
+            return -1;
+        if (base::add(rest...) == -1) {
+            col.erase(i);  // keep all columns the same length
+            return -1;
+        }
+        return i;
+    }
+    void erase(unsigned int index) {
+        col.erase(index);
+        base::erase(index);
+    }
+    void eraseUnordered(unsigned int index) {
+        col.eraseUnordered(index);
+        base::eraseUnordered(index);
+    }
+    void eraseAll() {
+        col.erase();
+        base::eraseAll();
+    }
+    bool reserve(unsigned int count) {
+        return col.reserve(count) && base::reserve(count);
+    }
+};
+
+}  // namespace details
+
+/*! \brief Structure-of-arrays container with one contiguous column per field.
+
+ustd_soa_array.h stores records of the field types Ts... column-wise: each field
+lives in its own \ref ustd::array, the same way \ref ustd::map keeps keys and
+values in separate arrays. A scan over one field (sum, min, search) touches
+only that column, so it is cache-dense and can use the vectorized functions of
+\ref ustd_simd.h or the algorithms of \ref ustd_algorithm.h directly on the
+column.
+
+Rows are added with add(a, b, c...) and erased in all columns at once, so all
+columns always have the same length. Rows can be iterated, each row gives
+access to its fields with get<I>().
+
+Make sure to provide the <a
+href="https://github.com/muwerk/ustd/blob/master/README.md">required platform
+define</a> before including ustd headers.
+
+## An example:
+
+~~~{.cpp}
+#define __UNIXOID__ 1   // Platform defines required, see doc, mainpage.
+#include <ustd_soa_array.h>
+#include <ustd_simd.h>
+
+// columns: timestamp, sensor id, value
+ustd::soa_array<unsigned long, int, float> telemetry;
+
+telemetry.add(1000, 3, 21.5f);
+telemetry.add(1010, 4, 22.0f);
+
+float total = ustd::sum(telemetry.column<2>());  // only the value column is read
+telemetry.get<2>(1) = 22.5f;                     // write a single field
+
+for (auto row : telemetry) {
+    printf("%lu: sensor %d = %f\n", row.get<0>(), row.get<1>(), row.get<2>());
+}
+~~~
+ */
+template <typename... Ts> class soa_array {
+    static_assert(sizeof...(Ts) > 0, "soa_array needs at least one column");
+
+  private:
+    details::soaColumns<0, Ts...> cols;
+    unsigned int size;
+
+  public:
+    /*! \brief Reference to one row of a \ref ustd::soa_array */
+    class row {
+      private:
+        soa_array *soa;
+        unsigned int index;
+
+      public:
+        row(soa_array *soa, unsigned int index) : soa(soa), index(index) {
+        }
+
+        template <unsigned int I> typename details::soaType<I, Ts...>::type &get() const {
+            /*! Field I of the row */
+            return soa->template get<I>(index);
+        }
+
+        unsigned int rowIndex() const {
+            /*! Index of the row in the soa_array */
+            return index;
+        }
+    };
+
+    /*! \brief Row iterator of a \ref ustd::soa_array */
+    class iterator {
+      private:
+        soa_array *soa;
+        unsigned int position;
+
+      public:
+        iterator(soa_array *soa, unsigned int position) : soa(soa), position(position) {
+        }
+        bool operator!=(const iterator &other) const {
+            return position != other.position;
+        }
+        bool operator==(const iterator &other) const {
+            return position == other.position;
+        }
+        iterator &operator++() {
+            ++position;
+            return *this;
+        }
+        row operator*() const {
+            return row(soa, position);
+        }
+    };
+
+    soa_array(unsigned int startSize = ARRAY_INIT_SIZE, unsigned int maxSize = ARRAY_MAX_SIZE,
+              unsigned int incSize = ARRAY_INC_SIZE, bool shrink = true,
+              arrayGrowth growth = arrayGrowth())
+        : cols(startSize, maxSize, incSize, shrink, growth), size(0) {
+        /*!
+         * Constructs a soa_array, the allocation hints are used for each
+         * column, see \ref ustd::array::array().
+         * @param startSize The number of rows that are allocated during object
+         * creation
+         * @param maxSize The maximal number of rows.
+         * @param incSize The number of rows that are allocated as a chunk if
+         * the columns need to grow
+         * @param shrink Boolean indicating, if the columns should deallocate
+         * memory, if the number of rows shrinks (due to erase()).
+         * @param growth Growth policy of the columns, see \ref ustd::arrayGrowth.
+         */
+    }
+
+    static constexpr unsigned int columns() {
+        /*! Number of columns
+        @return sizeof...(Ts) */
+        return sizeof...(Ts);
+    }
+
+    iterator begin() {
+        /*! Iterator support: begin(), iterates rows */
+        return iterator(this, 0);
+    }
+    iterator end() {
+        /*! Iterator support: end() */
+        return iterator(this, size);
+    }
+
+    int add(const Ts &...fields) {
+        /*! Append a row
+        @param fields one value per column
+        @return index of the new row or -1 on error, no column is changed on
+        error */
+        int i = cols.add(fields...);
+        if (i != -1)
+            ++size;
+        return i;
+    }
+
+    bool erase(unsigned int index) {
+        /*! Delete row at index in all columns, the order of the rows is kept
+        @param index row to delete
+        @return true on success, false if index is out of range */
+        if (index >= size)
+            return false;
+        cols.erase(index);
+        --size;
+        return true;
+    }
+
+    bool eraseUnordered(unsigned int index) {
+        /*! Delete row at index in O(1) by moving the last row into its place,
+        see \ref ustd::array::eraseUnordered().
+        @param index row to delete
+        @return true on success, false if index is out of range */
+        if (index >= size)
+            return false;
+        cols.eraseUnordered(index);
+        --size;
+        return true;
+    }
+
+    bool erase() {
+        /*! Delete all rows. Memory might be freed, if shrink=true during
+        creation. */
+        cols.eraseAll();
+        size = 0;
+        return true;
+    }
+
+    bool reserve(unsigned int count) {
+        /*! Make sure that all columns have memory for count rows
+        @return true on success */
+        return cols.reserve(count);
+    }
+
+    template <unsigned int I>
+    const array<typename details::soaType<I, Ts...>::type> &column() const {
+        /*! Read access to column I, e.g. for \ref ustd_simd.h functions or
+        iteration over a single field.
+        @return const reference to the column array */
+        return cols.column(details::soaIndex<I>());
+    }
+
+    template <unsigned int I> typename details::soaType<I, Ts...>::type *data() {
+        /*! Direct access to the contiguous entries of column I
+        @return pointer to the first field I, valid until rows are added or
+        erased */
+        return cols.column(details::soaIndex<I>()).data();
+    }
+
+    template <unsigned int I> typename details::soaType<I, Ts...>::type &get(unsigned int index) {
+        /*! Access field I of row index, e.g. soa.get<1>(5) = 3;
+        @param index row index, must be < length() */
+#if defined(__UNIXOID__)
+        assert(index < size);
+#endif
+        return cols.column(details::soaIndex<I>()).data()[index];
+    }
+
+    template <unsigned int I>
+    const typename details::soaType<I, Ts...>::type &get(unsigned int index) const {
+        /*! Read field I of row index
+        @param index row index, must be < length() */
+#if defined(__UNIXOID__)
+        assert(index < size);
+#endif
+        return cols.column(details::soaIndex<I>()).data()[index];
+    }
+
+    row operator[](unsigned int index) {
+        /*! Row at index, fields are accessed with get<I>() */
+        return row(this, index);
+    }
+
+    bool isEmpty() const {
+        /*! Check, if there are no rows
+        @return true if empty */
+        return size == 0;
+    }
+
+    unsigned int length() const {
+        /*! Number of rows
+        @return number of rows */
+        return size;
+    }
+};
+
+}  // namespace ustd
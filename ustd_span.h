@@ -0,0 +1,161 @@
+// ustd_span.h - non-owning view of contiguous entries
+
+#pragma once
+
+#include "ustd_array.h"
+#include "ustd_small_array.h"
+#include "ustd_static_array.h"
+
+namespace ustd {
+
+/*! \brief Non-owning view of contiguous entries: pointer and length.
+
+ustd_span.h provides a lightweight view that refers to the entries of a
+\ref ustd::array, \ref ustd::small_array, \ref ustd::static_array, the key or
+value array of a \ref ustd::map, or a C array without copying them. A span is
+just a pointer and a length, so it is passed by value. Functions that only
+read or modify existing entries can take a span instead of a container copy.
+
+span<T> allows modification of the entries, span<const T> is read-only. A
+span<T> converts implicitly to span<const T>. The span does not own the
+entries: it must not be used after the container was destroyed, and entries
+may move if the container is resized (add(), erase(), ...).
+
+Spans work with the algorithms of \ref ustd_algorithm.h and \ref ustd_simd.h.
+
+Make sure to provide the <a
+href="https://github.com/muwerk/ustd/blob/master/README.md">required platform
+define</a> before including ustd headers.
+
+## An example:
+
+~~~{.cpp}
+#define __UNO__ 1   // Platform defines required, see doc, mainpage.
+#include <ustd_span.h>
+
+int total(ustd::span<const int> values) {  // no copy, works for all containers
+    int s = 0;
+    for (auto v : values)
+        s += v;
+    return s;
+}
+
+const int table[] = {1, 2, 3, 4, 5};
+ustd::array<int> ar;
+ustd::map<int, int> mp;
+...
+total(table);                  // view of a const table, no copy into RAM
+total(ar);
+total(mp.keysArray());
+total(ustd::span<const int>(table).subspan(1, 3));  // 2, 3, 4
+~~~
+ */
+template <typename T> class span {
+  private:
+    typedef typename details::removeConst<T>::type value_type;
+    T *ptr;
+    unsigned int len;
+
+  public:
+    span() : ptr(nullptr), len(0) {
+        /*! Empty span */
+    }
+
+    span(T *entries, unsigned int count) : ptr(entries), len(count) {
+        /*! View of count entries starting at entries */
+    }
+
+    template <unsigned int N> span(T (&carray)[N]) : ptr(carray), len(N) {
+        /*! View of a C array, e.g. a const table */
+    }
+
+    template <typename U> span(const span<U> &other) : ptr(other.data()), len(other.length()) {
+        /*! Conversion from span<T> to span<const T> */
+    }
+
+    template <typename A> span(array<value_type, A> &ar) : ptr(ar.data()), len(ar.length()) {
+        /*! View of the entries of ar */
+    }
+
+    template <typename A>
+    span(const array<value_type, A> &ar) : ptr(ar.data()), len(ar.length()) {
+        /*! Read-only view of the entries of ar, only for span<const T> */
+    }
+
+    template <unsigned int N, typename A>
+    span(small_array<value_type, N, A> &ar) : ptr(ar.data()), len(ar.length()) {
+        /*! View of the entries of a small_array */
+    }
+
+    template <unsigned int N, typename A>
+    span(const small_array<value_type, N, A> &ar) : ptr(ar.data()), len(ar.length()) {
+        /*! Read-only view of the entries of a small_array, only for span<const T> */
+    }
+
+    template <unsigned int N>
+    span(static_array<value_type, N> &ar) : ptr(ar.data()), len(ar.length()) {
+        /*! View of the entries of a static_array */
+    }
+
+    template <unsigned int N>
+    span(const static_array<value_type, N> &ar) : ptr(ar.data()), len(ar.length()) {
+        /*! Read-only view of the entries of a static_array, only for span<const T> */
+    }
+
+    T *begin() const {
+        /*! Iterator support: begin() */
+        return ptr;
+    }
+
+    T *end() const {
+        /*! Iterator support: end() */
+        return ptr + len;
+    }
+
+    T &operator[](unsigned int i) const {
+        /*! Access entry i, i must be < length() */
+#if defined(__UNIXOID__)
+        assert(i < len);
+#endif
+        return ptr[i];
+    }
+
+    T *data() const {
+        /*! Pointer to the first entry */
+        return ptr;
+    }
+
+    unsigned int length() const {
+        /*! Number of entries in the view */
+        return len;
+    }
+
+    bool isEmpty() const {
+        /*! Check, if the view has no entries */
+        return len == 0;
+    }
+
+    span<T> first(unsigned int count) const {
+        /*! View of the first count entries (at most length()) */
+        return span<T>(ptr, count < len ? count : len);
+    }
+
+    span<T> last(unsigned int count) const {
+        /*! View of the last count entries (at most length()) */
+        if (count > len)
+            count = len;
+        return span<T>(ptr + len - count, count);
+    }
+
+    span<T> subspan(unsigned int offset, unsigned int count = ARRAY_MAX_SIZE) const {
+        /*! View of count entries starting at offset, both are clamped to the
+        view. Without count the view extends to the end. */
+        if (offset > len)
+            offset = len;
+        if (count > len - offset)
+            count = len - offset;
+        return span<T>(ptr + offset, count);
+    }
+};
+
+}  // namespace ustd
@@ -0,0 +1,241 @@
+// ustd_spsc_queue.h - lock-free single-producer/single-consumer queue
+
+#pragma once
+
+#include "ustd_memory.h"
+#include "ustd_atomic.h"
+
+namespace ustd {
+
+/*! \brief Wait-free single-producer/single-consumer ring buffer.
+
+ustd_spsc_queue.h provides a queue for the common case of exactly one producer
+(an interrupt handler on MCUs, a reader thread on Linux) and exactly one
+consumer (the main loop) that needs no interrupt-disable or mutex around
+push() and pop(). Both operations are wait-free, O(1) and never allocate.
+
+The producer only writes the tail index, the consumer only writes the head
+index, there is no shared size counter. The indices are published with
+acquire/release atomics on platforms with USTD_FEATURE_ATOMIC (Unixoids,
+ESP32, RP2040) and are separated by cache line padding (USTD_CACHE_LINE) to
+avoid false sharing between the cores. The padding does not raise the
+alignment of the class, so queues can be static, members or allocated with
+new. On single-core MCUs the indices are volatile
+words with compiler barriers, 16 bit indices on AVR are accessed with
+interrupts disabled for the two instructions of the access.
+
+push() must only be called by the producer, pop() and front() only by the
+consumer. length(), isEmpty() and peak() can be called from both sides, the
+result is a snapshot. Use \ref ustd::queue, if no concurrency is involved.
+
+Make sure to provide the <a
+href="https://github.com/muwerk/ustd/blob/master/README.md">required platform
+define</a> before including ustd headers.
+
+## An example:
+
+~~~{.cpp}
+#define __ESP32__ 1  // Appropriate platform define required
+#include <ustd_spsc_queue.h>
+
+ustd::spsc_queue<unsigned int> pulses(32);
+
+void IRAM_ATTR onPulse() {  // producer: interrupt handler
+    pulses.push(micros());
+}
+
+void loop() {  // consumer
+    unsigned int t;
+    while (pulses.pop(t)) {
+        printf("pulse at %u\n", t);
+    }
+}
+~~~
+ */
+template <class T, class Alloc = mallocAllocator> class spsc_queue {
+  private:
+    T *que;
+    unsigned int slots;  // maxSize + 1: one slot stays free to tell full from empty
+    T bad = {};
+    Alloc alloc;
+
+    // producer side
+    USTD_CACHE_PAD(pad0)
+    details::atomicIndex tail;  // next slot to write
+    unsigned int headCache;     // last head seen by the producer
+    details::atomicIndex peakSize;
+
+    // consumer side
+    USTD_CACHE_PAD(pad1)
+    details::atomicIndex head;  // next slot to read
+    unsigned int tailCache;     // last tail seen by the consumer
+    USTD_CACHE_PAD(pad2)
+
+    unsigned int next(unsigned int i) const {
+        return i + 1 == slots ? 0 : i + 1;
+    }
+
+    unsigned int distance(unsigned int h, unsigned int t) const {
+        return t >= h ? t - h : t + slots - h;
+    }
+
+    bool reserveSlot(unsigned int t) {
+        // producer: check, if slot t can be written
+        unsigned int n = next(t);
+        if (n == headCache) {
+            headCache = head.load();
+            if (n == headCache)
+                return false;
+        }
+        return true;
+    }
+
+    void commitSlot(unsigned int t) {
+        // producer: publish the entry in slot t
+        unsigned int n = next(t);
+        tail.store(n);
+        // headCache is never newer than head, so the length estimate is an
+        // upper bound: only refresh head, if the estimate exceeds the peak
+        unsigned int peak = peakSize.loadOwn();
+        if (distance(headCache, n) > peak) {
+            headCache = head.load();
+            unsigned int len = distance(headCache, n);
+            if (len > peak)
+                peakSize.store(len);
+        }
+    }
+
+  public:
+    spsc_queue(unsigned int maxQueueSize, const Alloc &alloc = Alloc())
+        : slots(maxQueueSize + 1), alloc(alloc), tail(0), headCache(0), peakSize(0), head(0),
+          tailCache(0) {
+        /*! Constructs a spsc_queue object
+        @param maxQueueSize The maximum number of entries, the queue
+        can hold.
+        @param alloc Allocator for the queue memory, see
+        \ref ustd::mallocAllocator.
+        */
+        que = (T *)this->alloc.allocate(sizeof(T) * slots);
+        if (que == nullptr)
+            slots = 1;  // push() always fails
+    }
+
+    spsc_queue(const spsc_queue &) = delete;
+    spsc_queue &operator=(const spsc_queue &) = delete;
+
+    ~spsc_queue() {
+        /*! Deallocate the queue, entries that were not popped are destroyed.
+        Neither producer nor consumer may access the queue any more. */
+        if (que != nullptr) {
+            for (unsigned int h = head.loadOwn(); h != tail.loadOwn(); h = next(h))
+                que[h].~T();
+            alloc.deallocate(que, sizeof(T) * slots);
+            que = nullptr;
+        }
+    }
+
+    bool push(const T &ent) {
+        /*! Push a new entry into the queue, producer only.
+        @param ent T element
+        @return true on success, false if queue is full.
+        */
+        unsigned int t = tail.loadOwn();
+        if (!reserveSlot(t))
+            return false;
+        ::new (static_cast<void *>(que + t)) T(ent);
+        commitSlot(t);
+        return true;
+    }
+
+    bool push(T &&ent) {
+        /*! Push a new entry into the queue by moving it, producer only.
+        @return true on success, false if queue is full.
+        */
+        unsigned int t = tail.loadOwn();
+        if (!reserveSlot(t))
+            return false;
+        ::new (static_cast<void *>(que + t)) T(static_cast<T &&>(ent));
+        commitSlot(t);
+        return true;
+    }
+
+    bool pop(T &ent) {
+        /*! Pop the oldest entry from the queue, consumer only.
+        @param ent receives the entry
+        @return true on success, false if the queue is empty, ent is unchanged
+        */
+        unsigned int h = head.loadOwn();
+        if (h == tailCache) {
+            tailCache = tail.load();
+            if (h == tailCache)
+                return false;
+        }
+        ent = static_cast<T &&>(que[h]);
+        que[h].~T();
+        head.store(next(h));
+        return true;
+    }
+
+    T pop() {
+        /*! Pop the oldest entry from the queue, consumer only.
+        @return the entry, or the value set by setInvalidValue() if the queue
+        is empty
+        */
+        T ent = bad;
+        pop(ent);
+        return ent;
+    }
+
+    T *front() {
+        /*! Access the oldest entry without removing it, consumer only.
+        @return pointer to the entry, nullptr if the queue is empty */
+        unsigned int h = head.loadOwn();
+        if (h == tailCache) {
+            tailCache = tail.load();
+            if (h == tailCache)
+                return nullptr;
+        }
+        return que + h;
+    }
+
+    void setInvalidValue(T &entryInvalidValue) {
+        /*! Set the value that's given back by pop(), if the queue is empty.
+        Must be called before producer and consumer are started.
+        * @param entryInvalidValue The value that is given back in case an
+        invalid operation (e.g. read from an empty queue) is tried.
+        */
+        bad = entryInvalidValue;
+    }
+
+    bool isEmpty() const {
+        /*! Check, if queue is empty.
+        @return true: queue empty, false: not empty.
+        */
+        return head.load() == tail.load();
+    }
+
+    unsigned int length() const {
+        /*! Check number of queue entries, a snapshot while the other side is
+        active.
+        @return number of entries in the queue.
+        */
+        unsigned int h = head.load();
+        return distance(h, tail.load());
+    }
+
+    unsigned int capacity() const {
+        /*! Maximum number of entries
+        @return the maximum number of entries the queue can hold */
+        return slots - 1;
+    }
+
+    unsigned int peak() const {
+        /*! Check the maxiumum number of entries that have been in the queue,
+        as seen by the producer.
+        @return max number of queue entries.
+         */
+        return peakSize.load();
+    }
+};
+
+}  // namespace ustd
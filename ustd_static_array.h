@@ -0,0 +1,253 @@
+// ustd_static_array.h - fixed capacity array without heap usage
+
+#pragma once
+
+#include "ustd_array.h"
+
+namespace ustd {
+
+/*! \brief Lightweight c++11 array with compile-time capacity and no heap usage.
+
+ustd_static_array.h provides an array with the interface of \ref ustd::array,
+whose storage for N entries is a member of the object. Unlike the static mode of
+\ref ustd::array (startSize==maxSize, incSize=0), static_array never calls
+malloc(), so it can't fail on allocation and can be placed in .bss or on the
+stack. Memory usage is known at compile time.
+
+Make sure to provide the <a
+href="https://github.com/muwerk/ustd/blob/master/README.md">required platform
+define</a> before including ustd headers.
+
+## An example:
+
+~~~{.cpp}
+#define __UNO__ 1   // Platform defines required, see doc, mainpage.
+#include <ustd_static_array.h>
+
+ustd::static_array<int, 5> channels;  // no heap, capacity 5
+
+channels.add(3);
+channels.add(4);
+for (auto c : channels) {
+    printf("%d\n", c);
+}
+static_assert(ustd::static_array<int, 5>::capacity() == 5, "");
+~~~
+ */
+template <typename T, unsigned int N> class static_array {
+    static_assert(N > 0, "static_array needs a capacity > 0");
+
+  private:
+    unsigned int size;
+    T bad = {};
+    alignas(T) unsigned char buf[N * sizeof(T)];
+
+    T *arr() {
+        return reinterpret_cast<T *>(buf);
+    }
+    const T *arr() const {
+        return reinterpret_cast<const T *>(buf);
+    }
+
+  public:
+    static_array() : size(0) {
+        /*! Constructs an empty static_array, no memory is allocated. */
+    }
+
+    static_array(const T initarray[], unsigned int count) : size(0) {
+        /*! construct static_array with const T[] c-array of length count
+        @param initarray c-array of type T
+        @param count number of entries in initarray, at most N entries are
+        copied. */
+        size = count < N ? count : N;
+        details::copyRange(arr(), initarray, size);
+    }
+
+    static_array(const static_array<T, N> &ar) : size(ar.size), bad(ar.bad) {
+        /*! static_array copy constructor */
+        details::copyRange(arr(), ar.arr(), size);
+    }
+
+    static_array<T, N> &operator=(const static_array<T, N> &ar) {
+        /*! static_array copy assignment */
+        if (this != &ar) {
+            details::destroyRange(arr(), size);
+            size = ar.size;
+            bad = ar.bad;
+            details::copyRange(arr(), ar.arr(), size);
+        }
+        return *this;
+    }
+
+    ~static_array() {
+        /*! Destroy all entries */
+        details::destroyRange(arr(), size);
+    }
+
+    static constexpr unsigned int capacity() {
+        /*! Compile-time capacity of the array
+        @return N */
+        return N;
+    }
+
+    // iterators
+    arrayIterator<T> begin() {
+        /*! Iterator support: begin() */
+        return arrayIterator<T>(arr(), 0);
+    }
+    arrayIterator<T> end() {
+        /*! Iterator support: end() */
+        return arrayIterator<T>(arr(), size);
+    }
+
+    arrayIterator<const T> begin() const {
+        /*! Iterator support: begin() */
+        return arrayIterator<const T>(arr(), 0);
+    }
+
+    arrayIterator<const T> end() const {
+        /*! Iterator support: end() */
+        return arrayIterator<const T>(arr(), size);
+    }
+
+    void setInvalidValue(T &entryInvalidValue) {
+        /*! Set the value that's given back, if read of an invalid
+        index is requested, see \ref ustd::array::setInvalidValue().
+        */
+        bad = entryInvalidValue;
+    }
+
+    int add(const T &entry) {
+        /*! Append an array element after the current end of the array
+         * @param entry array element that is appended
+         * @return index of the new entry or -1 if the array is full */
+        if (size >= N)
+            return -1;
+        ::new (static_cast<void *>(arr() + size)) T(entry);
+        ++size;
+        return size - 1;
+    }
+
+    int add(T &&entry) {
+        /*! Append an array element by moving it after the current end of the
+         * array
+         * @param entry array element that is moved into the array
+         * @return index of the new entry or -1 if the array is full */
+        if (size >= N)
+            return -1;
+        ::new (static_cast<void *>(arr() + size)) T(static_cast<T &&>(entry));
+        ++size;
+        return size - 1;
+    }
+
+    template <typename... Args> int emplace(Args &&...args) {
+        /*! Construct a new array element from args after the current end of
+         * the array
+         * @param args constructor arguments for the new element
+         * @return index of the new entry or -1 if the array is full */
+        if (size >= N)
+            return -1;
+        ::new (static_cast<void *>(arr() + size)) T(static_cast<Args &&>(args)...);
+        ++size;
+        return size - 1;
+    }
+
+    bool erase(unsigned int index) {
+        /*! Delete array element at given index
+         * @param index The array index of the element to be erased.
+         */
+        if (index >= size) {
+            return false;
+        }
+        details::moveLeft(arr() + index, arr() + index + 1, size - index - 1);
+        --size;
+        details::destroyRange(arr() + size, 1);
+        return true;
+    }
+
+    bool eraseUnordered(unsigned int index) {
+        /*! Delete array element at given index in O(1) by moving the last
+         * element into its place. The order of the array is not preserved.
+         * @param index The array index of the element to be erased.
+         */
+        if (index >= size) {
+            return false;
+        }
+        --size;
+        if (index != size)
+            arr()[index] = static_cast<T &&>(arr()[size]);
+        details::destroyRange(arr() + size, 1);
+        return true;
+    }
+
+    bool erase() {
+        /*! Delete all array elements. */
+        details::destroyRange(arr(), size);
+        size = 0;
+        return true;
+    }
+
+    T operator[](unsigned int i) const {
+        /*! Read content of array element at i, a=myArray[3] */
+        if (i >= size) {
+#if defined(__UNIXOID__)
+            assert(i < size);
+#endif
+            return bad;
+        }
+        return arr()[i];
+    }
+
+    T &operator[](unsigned int i) {
+        /*! Assign content of array element at i, e.g. myArray[3]=3. Writes
+        past the current end (but within capacity N) extend the array. */
+        if (i >= N) {
+#if defined(__UNIXOID__)
+            assert(i < N);
+#endif
+            return bad;
+        }
+        if (i >= size) {
+            details::constructRange(arr() + size, i + 1 - size);
+            size = i + 1;
+        }
+        return arr()[i];
+    }
+
+    T *data() {
+        /*! Direct access to the contiguous entries, e.g. for algorithms.
+        @return pointer to the first entry, valid until the array is modified */
+        return arr();
+    }
+
+    const T *data() const {
+        /*! Direct read access to the contiguous entries.
+        @return pointer to the first entry, valid until the array is modified */
+        return arr();
+    }
+
+    bool isEmpty() const {
+        /*! Check, if array is empty.
+        @return true if array empty, false otherwise. */
+        return size == 0;
+    }
+
+    bool isFull() const {
+        /*! Check, if all N entries are in use.
+        @return true if array is full, false otherwise. */
+        return size == N;
+    }
+
+    unsigned int length() const {
+        /*! Check number of array-members.
+        @return number of array entries */
+        return (size);
+    }
+
+    unsigned int alloclen() const {
+        /*! Number of entries available, same as capacity().
+         * @return N */
+        return N;
+    }
+};
+}  // namespace ustd